@@ -0,0 +1,141 @@
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gl_util.hpp>
+#include <quad_transform.hpp>
+#include <sprite_batch.hpp>
+
+using namespace std;
+
+// Data driven sprite skeletons. A Rig places one square sprite per bone
+// relative to its parent, a Clip holds one looping rotation curve per bone,
+// and Evaluate samples a clip for many characters at once into a flat pose
+// buffer that Rig::Submit draws from.
+namespace Animation {
+    // Hermite key, slope in value per cycle
+    struct Key {
+        float time; // [0, 1) of the cycle
+        float value;
+        float slope;
+    };
+
+    // Looping curve over one cycle, keys sorted by time. No keys means 0.
+    struct Curve {
+        vector<Key> keys;
+        float Sample(float t) const;
+        // Largest |f''| over the cycle, in value per cycle^2. Each segment is
+        // cubic, so f'' is linear in it and peaks at one of its keys.
+        float MaxSecondDerivative() const;
+    };
+
+    // Local bone rotations in degrees, at unit weight
+    struct Clip {
+        string name;
+        vector<Curve> tracks; // one per bone
+    };
+
+    struct Bone {
+        string name;
+        int parent; // -1 for the root, parents come before their children
+        int part;   // texture and size index, Character::BodyParts
+        float size;
+        // Joint in the parent's frame relative to its center, and the sprite
+        // center below the joint it rotates around
+        float joint_x, joint_y;
+        float pivot;
+    };
+
+    // Bones and their draw order per facing
+    class Rig {
+    public:
+        Rig() = default;
+        // A humanoid (torso, head, arms, legs) laid out from its part sizes,
+        // so any character type with the six body parts gets one for free
+        static Rig Humanoid(const array<float, 6>& part_sizes);
+
+        size_t Bones() const { return bones.size(); }
+        const Bone& GetBone(size_t i) const { return bones[i]; }
+
+        // Draws one character from its slice of a pose buffer. Slot n of the
+        // draw order goes to layer + n * layer_step, so a step of 0 keeps a
+        // character's parts in submission order within one layer. Flipping
+        // mirrors the sprites and swaps the arms in front.
+        void Submit(
+            SpriteBatch& batch,
+            const Textures::Region* part_regions,
+            const float* pose,
+            float x,
+            float y,
+            bool flip_x,
+            int layer,
+            int layer_step
+        ) const;
+
+    private:
+        vector<Bone> bones;
+        array<vector<int>, 2> draw_order; // facing right, facing left
+    };
+
+    // The walk cycle for Rig::Humanoid, limbs swinging by +-1 degree
+    const Clip& Walk();
+
+    // sin/cos of an angle in degrees baked at a fixed step and linearly
+    // interpolated, so posing a rig costs no trig. Interpolating sin or cos at
+    // a spacing of h radians is off by at most h^2 / 8, under 1e-6 at the
+    // default step.
+    class RotationTable {
+    public:
+        explicit RotationTable(int steps_per_degree = 8);
+
+        QuadTransform::Rotation Degrees(float angle) const;
+
+    private:
+        int steps_per_degree;
+        int period; // steps per turn
+        // period + 1 entries, the last repeats the first
+        vector<QuadTransform::Rotation> samples;
+    };
+
+    // poses[i * n_bones + b] = weight[i] * track b at cycle phase[i] / (2 pi).
+    // phase is the limb animation timer in radians.
+    void Evaluate(const Clip& clip, const float* phase, const float* weight, size_t n, float* poses);
+
+    // A clip baked at a fixed number of samples per cycle and read back with
+    // linear interpolation, one lookup per character for all its bones. Off
+    // from the curves by at most weight * M / (8 resolution^2), M being the
+    // largest Curve::MaxSecondDerivative of the clip.
+    class Table {
+    public:
+        explicit Table(const Clip& clip, int resolution = 256);
+
+        // Same contract as Animation::Evaluate
+        void Evaluate(const float* phase, const float* weight, size_t n, float* poses) const;
+
+        size_t Bones() const { return n_bones; }
+        int Resolution() const { return resolution; }
+
+    private:
+        int resolution;
+        size_t n_bones;
+        // (resolution + 1) rows of n_bones, the last repeats the first so a
+        // lookup never wraps
+        vector<float> samples;
+    };
+
+    // Sample the walk cycle from its baked table instead of the curves, and
+    // have Rig::Submit look bone rotations up instead of calling sin and cos.
+    // Set before the first frame, the tables are baked on first use.
+    extern bool use_tables;
+    const Table& WalkTable();
+    const RotationTable& Rotations();
+    // Walk() through the table or the curves, per use_tables. Walk and sprint
+    // share the cycle, the gait only changes speed (phase rate) and amplitude
+    // (weight).
+    void EvaluateWalk(const float* phase, const float* weight, size_t n, float* poses);
+}
+
+#endif // ANIMATION_HPP
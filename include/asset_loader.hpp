@@ -0,0 +1,59 @@
+#ifndef ASSET_LOADER_HPP
+#define ASSET_LOADER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+using namespace std;
+
+// Decoded, premultiplied RGBA8 pixels, bottom row first like LoadTexture
+struct Image {
+    string path;
+    int w = 0;
+    int h = 0;
+    shared_ptr<unsigned char> pixels;
+};
+
+// Safe to call from any thread. Goes through TextureCache first.
+Image DecodeImage(const string& path);
+// GL thread only
+unsigned int UploadTexture(const Image& image);
+
+// Decodes images on a pool of worker threads. Finished images are handed back
+// to the GL thread through Poll so uploads stay on the thread owning the context.
+class AssetLoader {
+public:
+    // 0 threads decodes inline in Queue, the old serial behaviour
+    explicit AssetLoader(unsigned int n_threads = thread::hardware_concurrency());
+    ~AssetLoader();
+
+    void Queue(const string& path);
+    // Images finished since the last call. Rethrows a worker's decode error.
+    vector<Image> Poll();
+    // Blocks until an image is ready to Poll, or the timeout passes
+    void Wait(chrono::milliseconds timeout);
+    bool Done();
+
+private:
+    void Worker();
+
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake;
+    condition_variable ready;
+    deque<string> jobs;
+    vector<Image> finished;
+    exception_ptr error;
+    size_t queued;
+    size_t polled;
+    bool stopping;
+};
+
+#endif // ASSET_LOADER_HPP
@@ -0,0 +1,47 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+class Character;
+class SpriteBatch;
+class GpuTimer;
+
+// Small timing helpers shared by the --bench-* modes, and the modes that
+// don't need the frame loop
+namespace Bench {
+    struct Stats {
+        double mean_ms;
+        double p50_ms;
+        double p95_ms;
+        double p99_ms;
+        double min_ms;
+    };
+
+    Stats Summarize(vector<double> samples_ms);
+
+    // Times each call of fn. between runs untimed after every call, e.g. glFinish.
+    Stats Time(int iterations, const function<void()>& fn, const function<void()>& between = nullptr);
+
+    void PrintHeader(const string& title);
+    void PrintRow(const string& label, const Stats& stats, const string& extra = "");
+
+    // --bench-tiles, CPU submission time per frame for each tile path at a
+    // few virtual widths. resize applies a new Screen size, frame renders
+    // one frame with the given path.
+    void TilePaths(GpuTimer& gpu_timer, const function<void()>& resize, const function<void(bool instancing, bool layer_cache)>& frame);
+    // --bench-physics
+    void CrowdPhysics(const Character& prototype);
+    // --bench-transform
+    void SpriteCorners();
+    // --bench-animation, needs a GL context for the batch
+    void WalkPoses(const Character& prototype, SpriteBatch& batch);
+    // --bench-collision
+    void CollisionPairs();
+}
+
+#endif // BENCH_HPP
@@ -0,0 +1,31 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <glm/glm.hpp>
+
+#include <collision.hpp>
+
+// The part of the world on screen, in the batch's coordinates (y up, world x
+// unchanged). Follows a target horizontally and never leaves the world.
+// Render side only, the simulation doesn't know about it.
+class Camera {
+public:
+    float x = 0.0f, y = 0.0f; // bottom left
+    float w = 0.0f, h = 0.0f;
+
+    // Eases toward centering target_x, closing 1 - e^-1 of the gap every
+    // 1 / FOLLOW_RATE seconds whatever the frame rate
+    void Follow(float target_x, float world_w, float dt);
+    // Centers on target_x at once
+    void Snap(float target_x, float world_w);
+
+    Collision::Box View() const { return {x, y, w, h}; }
+    glm::mat4 Projection() const;
+
+    static constexpr float FOLLOW_RATE = 6.0f;
+
+private:
+    float Clamp(float left, float world_w) const;
+};
+
+#endif // CAMERA_HPP
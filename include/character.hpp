@@ -4,12 +4,16 @@
 #include <string>
 #include <map>
 #include <array>
+#include <vector>
 #include <iostream>
 #include <cmath>
 
-#include "stb_image.h"
-
 #include <gl_util.hpp>
+#include <sprite_batch.hpp>
+#include <texture_manager.hpp>
+#include <asset_loader.hpp>
+#include <animation.hpp>
+#include <collision.hpp>
 #include <settings.hpp>
 
 using namespace std;
@@ -28,10 +32,6 @@ public:
     float height;
     float width;
     
-    float left_leg_angle;
-    float right_leg_angle;
-    float left_arm_angle;
-    float right_arm_angle;
     float limb_animation_timer;
     float limb_animation_speed;
     float limb_rotation_amplitude;
@@ -52,13 +52,28 @@ public:
 
     bool is_colliding;
 
-    array<unsigned int, 6> textures;
+    array<TextureHandle, 6> textures;
     array<float, 6> texture_sizes;
 
-    unsigned int collision_texture;
+    TextureHandle collision_texture;
     float collision_texture_size;
 
-    Character(int character_type, bool debug_mode = false);
+    // Laid out from texture_sizes, animated by Animation::Walk
+    Animation::Rig rig;
+
+    // Everything Render reads that changes per tick. Snapshots of it go to the
+    // render thread, which interpolates between the last two.
+    struct Pose {
+        array<float, 2> position;
+        float limb_phase;  // limb_animation_timer
+        float limb_weight; // blend * amplitude, the clip's degrees at full swing
+        bool flip_x;
+    };
+
+    Character(int character_type, TextureManager& texture_manager, bool debug_mode = false);
+
+    // Images to preload into the TextureManager before constructing this character type
+    static vector<string> TexturePaths(int character_type);
 
     void ApplyForce(float force[2]);
     float CalculateJumpVelocity();
@@ -66,14 +81,28 @@ public:
     void Move(bool move_left, bool move_right, bool sprinting);
     void Update(float dt);
     void UpdateTimes(float dt);
-    void Render(glm::mat4& model, unsigned int shader_program, bool moving_right, bool moving_left);
+    Pose CurrentPose(bool moving_right, bool moving_left) const;
+    // The box Update clamps to the world
+    Collision::Box Bounds() const { return {position[0], position[1], width, height}; }
+    // alpha 0 draws previous, 1 current. Nothing is submitted when the
+    // character is outside view. Only reads immutable members besides the
+    // poses, so it is safe while another thread updates this character.
+    void Render(SpriteBatch& batch, const Pose& previous, const Pose& current, const Collision::Box& view, float alpha = 1.0f) const;
+    // Whether a character drawn centered on (x, y) can reach into view
+    bool InView(const Collision::Box& view, float x, float y) const;
+
+    // Mixes position, velocity, on_ground and the limb angles as the walk
+    // clip evaluates them into hash
+    uint64_t Hash(uint64_t hash) const;
 
     ~Character() {
-        // TODO: Check if needed
-        glDeleteTextures(6, textures.data());
-        cout << "Character destroyed" << endl;
+        // Texture handles release themselves. Quiet outside debug mode, the
+        // physics bench creates and drops up to a million of these.
+        if (DEBUG_MODE) cout << "Character destroyed" << endl;
     }
 private:
+    friend class Crowd;
+
     enum BodyParts {
         Head = 0,
         Torso = 1,
@@ -89,7 +118,7 @@ private:
         float size;
     };
 
-    const map<int, map<int, BodyPart>> Characters = {
+    inline static const map<int, map<int, BodyPart>> Characters = {
         {Goblin, {
             {Head, {"pngs/goblin/Head_480_480.png", 480.0f * Settings::CHARACTER_SCALE}},
             {Torso, {"pngs/goblin/Torso_320_320.png", 320.0f * Settings::CHARACTER_SCALE}},
@@ -108,8 +137,8 @@ private:
         }},
     };
 
-    const char* collision_texture_path = "pngs/collision_box.png";
-    const float collision_texture_init_size = 480.0f;
+    inline static const char* collision_texture_path = "pngs/collision_box.png";
+    inline static const float collision_texture_init_size = 480.0f;
 };
 
 #endif // CHARACTER_HPP
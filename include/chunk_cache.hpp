@@ -0,0 +1,65 @@
+#ifndef CHUNK_CACHE_HPP
+#define CHUNK_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <gl_util.hpp>
+#include <sprite_batch.hpp>
+#include <tile_layer.hpp>
+#include <tile_map.hpp>
+
+using namespace std;
+
+// GPU side of a TileMap. Chunks near the view are built into instanced
+// TileLayers the first time they're needed and kept until the least recently
+// used ones are recycled for new chunks, so memory and upload cost follow the
+// view rather than the width of the world. GL thread only.
+class ChunkCache {
+public:
+    // textures[i] draws layer i of map, which must outlive the cache
+    ChunkCache(const TileMap& map, const vector<Textures::Texture>& textures, size_t max_chunks = 64);
+
+    // Once per frame before drawing. Builds every chunk overlapping the view
+    // widened by margin on each side, so chunks are ready before they scroll
+    // in, and picks the ones overlapping the view itself for drawing.
+    // Chunks in use this frame are never evicted, the cache grows instead.
+    void Update(float x0, float y0, float x1, float y1, float margin);
+
+    void Draw(size_t layer) const;
+    // Fallback for the non-instanced path, at the layer's sprite layer
+    void Submit(SpriteBatch& batch, size_t layer) const;
+
+    size_t Resident() const { return resident.size(); }
+    size_t Builds() const { return builds; }
+    size_t Evictions() const { return evictions; }
+
+private:
+    struct Entry {
+        unique_ptr<TileLayer> tiles;
+        list<uint64_t>::iterator recent;
+        unsigned long used; // frame
+    };
+
+    static uint64_t Key(size_t layer, int chunk_x, int chunk_y);
+    TileLayer& Acquire(size_t layer, int chunk_x, int chunk_y);
+    void Build(TileLayer& tiles, size_t layer, int chunk_x, int chunk_y);
+
+    const TileMap& map;
+    vector<Textures::Texture> textures;
+    size_t max_chunks;
+
+    unordered_map<uint64_t, Entry> resident;
+    list<uint64_t> recent; // most recently used first
+    vector<vector<const TileLayer*>> visible; // per layer
+    vector<TileLayer::Instance> scratch;
+
+    unsigned long frame;
+    size_t builds;
+    size_t evictions;
+};
+
+#endif // CHUNK_CACHE_HPP
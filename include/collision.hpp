@@ -0,0 +1,81 @@
+#ifndef COLLISION_HPP
+#define COLLISION_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Broad phase for character collisions. A uniform grid hashed by cell holds
+// each box in every cell it covers, so finding overlaps only tests boxes that
+// share a cell: O(n) on average while boxes are about a cell in size and
+// spread out, instead of testing every pair.
+namespace Collision {
+    // Axis aligned, min corner and extent in the same space as
+    // Character::position, width and height
+    struct Box {
+        float x, y;
+        float w, h;
+    };
+
+    // Touching edges don't count, a character resting against another
+    // isn't colliding with it
+    inline bool Overlaps(const Box& a, const Box& b) {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+    struct Pair {
+        uint32_t a, b; // a < b
+    };
+
+    // Every overlapping pair of n boxes by testing all of them, the reference
+    // the grid is checked against
+    void BruteForcePairs(const Box* boxes, size_t n, vector<Pair>& out);
+
+    class SpatialHash {
+    public:
+        // Cells should be at least as large as a typical box, so each box
+        // covers a few cells at most
+        explicit SpatialHash(float cell_size);
+
+        // Adds box under id or moves it there. Ids index a dense array, keep
+        // them small. The cells are only relinked when the range of cells the
+        // box covers changes, for characters moving less than a cell per tick
+        // that's a small fraction of updates.
+        void Update(uint32_t id, const Box& box);
+        void Remove(uint32_t id);
+        void Clear();
+
+        // Every overlapping pair once, in no particular order. Replaces out.
+        void Pairs(vector<Pair>& out) const;
+        // Ids of the boxes overlapping box. Replaces out.
+        void Query(const Box& box, vector<uint32_t>& out) const;
+
+        size_t Size() const { return size; }
+
+    private:
+        struct Range {
+            int32_t x0, y0, x1, y1; // inclusive
+        };
+        struct Entry {
+            Box box;
+            Range cells;
+            bool present = false;
+        };
+
+        Range Cover(const Box& box) const;
+        static uint64_t Key(int32_t x, int32_t y);
+        void Link(uint32_t id, const Range& cells);
+        void Unlink(uint32_t id, const Range& cells);
+
+        float inv_cell_size;
+        size_t size;
+        vector<Entry> entries;
+        // Emptied cells keep their bucket, the world is bounded and refilling
+        // one then doesn't allocate
+        unordered_map<uint64_t, vector<uint32_t>> cells;
+    };
+}
+
+#endif // COLLISION_HPP
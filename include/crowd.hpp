@@ -0,0 +1,125 @@
+#ifndef CROWD_HPP
+#define CROWD_HPP
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include <character.hpp>
+#include <crowd_kernels.hpp>
+#include <collision.hpp>
+#include <sprite_batch.hpp>
+
+using namespace std;
+
+// Many goblins driven by random input. Same physics and animation as
+// Character, but the state lives in one array per field so each step is a
+// tight loop over contiguous floats instead of a walk over Character objects.
+class Crowd {
+public:
+    // Every member shares the prototype's textures and sizes
+    Crowd(const Character& prototype, size_t n, uint32_t seed);
+
+    size_t Size() const { return pos_x.size(); }
+
+    // Use the AVX2 Update kernel when the CPU has it
+    bool simd = true;
+
+    // The whole per-frame update, in the same order main runs it for the player
+    void Step(float dt);
+
+    void RandomizeInputs(float dt);
+    void Move();
+    void UpdateTimes(float dt);
+    void Jump();
+    void Update(float dt);
+
+    // Refreshes the members' boxes in the grid and finds the overlapping
+    // pairs, sorted. Not part of Step, Simulation runs it after stepping
+    // everyone so the player can be tested against the same grid.
+    void Collide();
+    // Whether box overlaps any member as of the last Collide
+    bool Touches(const Collision::Box& box);
+    const vector<Collision::Pair>& Contacts() const { return contacts; }
+    bool Colliding(size_t i) const { return colliding[i] != 0; }
+
+    // Narrow phase response. Members only push sideways, the floor and the
+    // world edges stay Update's. Separate moves each pair from the last
+    // Collide half their overlap apart, summed per member so the result
+    // doesn't depend on pair order. PushOut moves members overlapping box
+    // entirely clear of it, the player barges through the crowd.
+    void Separate();
+    void PushOut(const Collision::Box& box);
+
+    // Every member through Character::Hash in order, so member i mixes
+    // exactly what a Character in its state would. Simulation thread.
+    uint64_t Hash(uint64_t hash) const;
+
+    // Per tick render state, the crowd's counterpart of Character::Pose
+    struct Poses {
+        vector<float> x, y;
+        vector<float> limb_phase, limb_weight;
+        vector<uint8_t> flip_x;
+    };
+    // Reuses the vectors' storage
+    void StorePoses(Poses& poses) const;
+
+    // All parts go in one layer in per-goblin order. The batch sort is stable,
+    // so as long as the parts share an atlas page this keeps each goblin's
+    // part order and is still a single draw. Members outside view are
+    // dropped first, then the walk clip is evaluated for the rest at once.
+    // Safe while another thread steps the crowd, like Character::Render, but
+    // only one thread may render.
+    void Render(SpriteBatch& batch, const Poses& previous, const Poses& current, const Collision::Box& view, float alpha = 1.0f) const;
+
+    // Copies member i's state into a Character, for comparing against the
+    // per-object code path.
+    void Store(size_t i, Character& character) const;
+
+private:
+    uint32_t Random();
+    float RandomFloat(float lo, float hi);
+    CrowdKernels::Arrays Arrays();
+
+    array<TextureHandle, 6> textures;
+    array<float, 6> texture_sizes;
+    Animation::Rig rig;
+    float height;
+    float width;
+    float spawn_y;
+    uint32_t rng;
+
+    vector<float> pos_x, pos_y;
+    vector<float> vel_x, vel_y;
+    vector<float> acc_x, acc_y;
+
+    vector<float> limb_timer;
+    vector<float> limb_speed;
+    vector<float> limb_amplitude;
+    vector<float> limb_blend;
+
+    vector<float> time_since_left_ground;
+    vector<float> time_since_jump_pressed;
+    vector<int32_t> on_ground;
+
+    vector<uint8_t> move_left, move_right, sprinting;
+    vector<float> input_timer;
+
+    // Cells the size of a goblin, so each covers at most four
+    Collision::SpatialHash grid;
+    vector<Collision::Pair> contacts;
+    vector<uint8_t> colliding;
+    vector<uint32_t> hits;
+    vector<float> push;
+
+    // Hash scratch, separate from render's which another thread may be using
+    mutable vector<float> hash_weight, hash_poses;
+
+    // Render thread scratch, the visible members, their interpolated inputs
+    // and the flat pose buffer
+    mutable vector<uint32_t> render_visible;
+    mutable vector<float> render_x, render_y;
+    mutable vector<float> render_phase, render_weight, render_poses;
+};
+
+#endif // CROWD_HPP
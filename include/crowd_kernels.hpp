@@ -0,0 +1,41 @@
+#ifndef CROWD_KERNELS_HPP
+#define CROWD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// The integration step of Crowd::Update over raw arrays, so the same state can
+// be stepped by the scalar loop or 8 lanes at a time.
+namespace CrowdKernels {
+    struct Arrays {
+        float* pos_x;
+        float* pos_y;
+        float* vel_x;
+        float* vel_y;
+        float* acc_x;
+        float* acc_y;
+        float* limb_timer;
+        const float* limb_speed;
+        float* limb_blend;
+        float* time_since_left_ground;
+        int32_t* on_ground;
+    };
+
+    struct Params {
+        float dt;
+        float height;
+        float width;
+    };
+
+    // Matches Character::Update bit for bit
+    void UpdateScalar(const Arrays& arrays, size_t begin, size_t end, const Params& params);
+
+    // AVX2, 8 characters per iteration with branchless clamps. Handles
+    // [begin, end) rounded down to a multiple of 8 and returns where it stopped,
+    // the caller finishes the tail with UpdateScalar. Matches the scalar path
+    // exactly. Returns begin if AVX2 isn't available.
+    size_t UpdateAvx2(const Arrays& arrays, size_t begin, size_t end, const Params& params);
+    bool Avx2Supported();
+}
+
+#endif // CROWD_KERNELS_HPP
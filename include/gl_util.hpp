@@ -10,6 +10,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <settings.hpp>
+#include <shader_program.hpp>
 
 using namespace std;
 
@@ -29,8 +30,22 @@ namespace Textures {
         float w;
         float h;
     };
-    struct Texture {
+    // Normalized texture coordinates of a sprite, (u0, v0) bottom left
+    struct UVRect {
+        float u0;
+        float v0;
+        float u1;
+        float v1;
+    };
+    constexpr UVRect FULL_UV = {0.0f, 0.0f, 1.0f, 1.0f};
+
+    // A whole texture or a sub-rect of an atlas page
+    struct Region {
         unsigned int texture;
+        UVRect uv;
+    };
+    struct Texture {
+        Region region;
         Dim dim;
     };
     struct TextureConfig {
@@ -62,7 +77,7 @@ namespace Mouse {
     extern float pos_x;
     extern float pos_y; 
     extern bool visible;
-    extern unsigned int texture;
+    extern Textures::Region texture;
     extern float size_x;
     extern float size_y;
 }
@@ -82,10 +97,23 @@ namespace Keys {
 namespace FrameTracker {
     extern float fps;
     extern int frame_count;
+    extern unsigned long total_frames;
     extern float fps_timer; 
     extern float last_frame_time;
     extern float current_frame_time;
     extern float dt;
+    extern float worst_dt; // longest frame since the title was last updated
+    extern float alpha; // how far rendering is between the previous and current tick
+}
+
+// ----------------------------------
+
+namespace RenderStats {
+    extern unsigned int draw_calls;
+    extern unsigned int texture_binds;
+    extern unsigned int sprites;
+    extern unsigned int culled; // sprites SpriteBatch dropped outside its view
+    void Reset();
 }
 
 // ----------------------------------
@@ -100,18 +128,19 @@ namespace GlCallback {
 
 namespace GlShaders {
     unsigned int CompileShader(GLenum type, const char* source);
+    unsigned int LinkProgram(const char* vertex_source, const char* fragment_source);
     unsigned int CreateShaderProgram();
-    void Render (
-        glm::mat4& model, 
-        unsigned int shader_program, 
-        unsigned int texture, 
-        float x, 
-        float y, 
-        float width, 
-        float height,
-        float angle,
-        bool flip_x
-    );
+    unsigned int CreateTileShaderProgram();
+
+    // Handles into the program built by CreateShaderProgram, fetched once
+    struct SpriteUniforms {
+        ShaderProgram::Uniform<glm::mat4> model;
+        ShaderProgram::Uniform<glm::mat4> projection;
+        ShaderProgram::Uniform<glm::vec4> uv_rect;
+        ShaderProgram::Uniform<int> texture1;
+
+        explicit SpriteUniforms(const ShaderProgram& shader);
+    };
 }
 
 #endif // GL_UTIL_HPP
\ No newline at end of file
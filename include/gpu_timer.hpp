@@ -0,0 +1,32 @@
+#ifndef GPU_TIMER_HPP
+#define GPU_TIMER_HPP
+
+#include <array>
+
+#include <glad/glad.h>
+
+using namespace std;
+
+// GL_TIME_ELAPSED over a small ring of queries. Results are read a few frames
+// late so checking them never stalls the pipeline.
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    void Begin();
+    void End();
+
+    // Most recent finished measurement
+    double LastMs() const { return last_ms; }
+
+private:
+    static constexpr int N_QUERIES = 4;
+
+    array<unsigned int, N_QUERIES> queries;
+    array<bool, N_QUERIES> pending;
+    int current;
+    double last_ms;
+};
+
+#endif // GPU_TIMER_HPP
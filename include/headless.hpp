@@ -0,0 +1,39 @@
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <vector>
+
+using namespace std;
+
+// Offscreen GL 3.3 core context for machines without a display, through EGL
+// (surfaceless where the driver has it, a 1x1 pbuffer otherwise). Only
+// available on Linux builds.
+class HeadlessContext {
+public:
+    static bool Supported();
+
+    // Creates the context and makes it current. Load glad with ProcAddress
+    // afterwards, then call CreateFramebuffer.
+    HeadlessContext();
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    static void* ProcAddress(const char* name);
+
+    // The stand-in for the window's default framebuffer, left bound with a
+    // matching viewport.
+    void CreateFramebuffer(int width, int height);
+    // RGBA8, bottom row first
+    vector<unsigned char> ReadPixels() const;
+
+private:
+    void* display;
+    void* context;
+    void* surface;
+    unsigned int FBO;
+    unsigned int color_buffer;
+    int width, height;
+};
+
+#endif // HEADLESS_HPP
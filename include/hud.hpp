@@ -0,0 +1,66 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include <array>
+#include <string>
+
+#include <glad/glad.h>
+
+#include <gl_util.hpp>
+#include <sprite_batch.hpp>
+
+using namespace std;
+
+// Performance overlay drawn through the sprite batch. Text and graph share one
+// small texture holding a 5x7 bitmap font and a few solid colour swatches, so
+// the whole overlay is a single draw. GL thread only.
+class Hud {
+public:
+    struct Sample {
+        float frame_ms;
+        float tick_ms;   // one simulation tick
+        float render_ms; // CPU side of render_world
+        float gpu_ms;    // negative when not measured
+        unsigned int draw_calls;
+        unsigned int texture_binds;
+        unsigned int sprites;
+        size_t entities;
+    };
+
+    Hud();
+    ~Hud();
+    Hud(const Hud&) = delete;
+    Hud& operator=(const Hud&) = delete;
+
+    // Once per finished frame, whether visible or not so the graph is full
+    // when it's toggled on. Text refreshes a few times per second, averaged.
+    void Push(const Sample& sample);
+    // Queues the overlay at Layers::Hud
+    void Submit(SpriteBatch& batch) const;
+
+    bool visible = false;
+
+private:
+    enum Swatch { White, Green, Yellow, Red, Panel, N_Swatches };
+
+    void Text(SpriteBatch& batch, const string& text, float x, float y) const;
+    void Rect(SpriteBatch& batch, Swatch swatch, float x, float y, float w, float h) const;
+
+    static constexpr int N_GLYPHS = 96; // printable ASCII from ' '
+    static constexpr int HISTORY = 120;
+    static constexpr int N_LINES = 4;
+
+    unsigned int texture;
+    array<Textures::Region, N_GLYPHS> glyphs;
+    array<Textures::Region, N_Swatches> swatches;
+
+    array<float, HISTORY> history;
+    int next;
+
+    Sample sum;
+    int n_summed;
+    float elapsed_ms;
+    array<string, N_LINES> lines;
+};
+
+#endif // HUD_HPP
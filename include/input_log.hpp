@@ -0,0 +1,54 @@
+#ifndef INPUT_LOG_HPP
+#define INPUT_LOG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The input each simulation tick consumed, as a compact binary log. The
+// header holds what else a run depends on (tick rate, crowd size and seed),
+// then one record per tick the input changed on, then the tick count and the
+// run's state hash, every tick's hash chained. Replaying it through the fixed step reproduces the
+// run tick for tick, whatever the frame rate either time.
+class InputLog {
+public:
+    enum Bits : uint8_t {
+        MoveLeft = 1 << 0,
+        MoveRight = 1 << 1,
+        Jump = 1 << 2, // the press edge, set for one tick
+        Sprint = 1 << 3,
+    };
+
+    float tick_rate = 0.0f;
+    uint32_t crowd = 0;
+    uint32_t seed = 0;
+
+    // Recording, ticks in increasing order
+    void Record(unsigned long tick, uint8_t bits);
+    void Finish(unsigned long ticks, uint64_t state_hash);
+    void Save(const string& path) const;
+
+    // Throws if the file is missing, truncated or not an input log
+    static InputLog Load(const string& path);
+    // Input of tick, which must not be less than the previous call's
+    uint8_t At(unsigned long tick) const;
+
+    unsigned long Ticks() const { return ticks; }
+    uint64_t StateHash() const { return state_hash; }
+    size_t Records() const { return records.size(); }
+
+private:
+    struct Change {
+        uint32_t tick;
+        uint8_t bits;
+    };
+
+    vector<Change> records;
+    unsigned long ticks = 0;
+    uint64_t state_hash = 0;
+    mutable size_t cursor = 0;
+};
+
+#endif // INPUT_LOG_HPP
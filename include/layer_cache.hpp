@@ -0,0 +1,34 @@
+#ifndef LAYER_CACHE_HPP
+#define LAYER_CACHE_HPP
+
+#include <glad/glad.h>
+
+#include <gl_util.hpp>
+
+// Render-to-texture target for layers that don't change between frames.
+// Draw them once between Begin/End, then blit Region() as a single quad.
+// The cached pixels are premultiplied like every other texture.
+class LayerCache {
+public:
+    LayerCache();
+    ~LayerCache();
+
+    bool Valid(int width, int height) const { return valid && width == this->width && height == this->height; }
+    void Invalidate() { valid = false; }
+
+    // (Re)allocates the color texture when the size changes
+    void Begin(int width, int height);
+    void End();
+
+    Textures::Region Region() const { return {color_texture, Textures::FULL_UV}; }
+
+private:
+    unsigned int FBO;
+    unsigned int color_texture;
+    int width, height;
+    int saved_viewport[4];
+    int saved_framebuffer;
+    bool valid;
+};
+
+#endif // LAYER_CACHE_HPP
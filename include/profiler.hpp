@@ -0,0 +1,69 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <bench.hpp>
+
+using namespace std;
+
+// Frame instrumentation. CPU scopes from any thread and GPU passes from the
+// GL thread go into one lock-free ring of the most recent events, which can be
+// written out as a Chrome trace (chrome://tracing, ui.perfetto.dev). Costs a
+// branch per scope while disabled.
+namespace Profiler {
+    struct Event {
+        const char* name; // string literal, kept by pointer
+        int64_t start_ns;
+        int64_t duration_ns;
+        uint32_t thread;
+    };
+
+    // Events on this track are GPU passes, placed on the CPU clock
+    constexpr uint32_t GPU_THREAD = 0xffff;
+
+    extern bool enabled;
+
+    // Nanoseconds since the first call
+    int64_t Now();
+    // Names the calling thread's track in the trace
+    void SetThreadName(const char* name);
+    void Record(const char* name, int64_t start_ns, int64_t duration_ns);
+
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name), start_ns(enabled ? Now() : -1) {}
+        ~Scope() {
+            if (start_ns >= 0) Record(name, start_ns, Now() - start_ns);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        int64_t start_ns;
+    };
+
+    // GL_TIMESTAMP pairs around a pass, GL thread only. Timestamps rather than
+    // GL_TIME_ELAPSED because those can't nest inside the frame's GpuTimer.
+    // Passes may nest. Results are collected a few frames late, never stalling.
+    void BeginGpu(const char* name);
+    void EndGpu();
+    void CollectGpu();
+
+    // Whole frame times for the percentiles
+    void FrameDone(double frame_ms);
+    Bench::Stats FrameStats();
+
+    // Everything still in the ring, oldest first
+    vector<Event> Events();
+    void WriteChromeTrace(const string& path);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+#endif // PROFILER_HPP
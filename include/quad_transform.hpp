@@ -0,0 +1,52 @@
+#ifndef QUAD_TRANSFORM_HPP
+#define QUAD_TRANSFORM_HPP
+
+#include <cmath>
+
+// Corners of a 2D sprite quad straight from its center, half extents and
+// rotation, the same result as translate * rotate * scale applied to the unit
+// quad without building a matrix. Header only so batchers can inline it.
+namespace QuadTransform {
+    // sin/cos of a sprite angle, computed once and reused for every quad at
+    // that angle (or its negation, see Inverse)
+    struct Rotation {
+        float sin;
+        float cos;
+
+        static Rotation Degrees(float angle) {
+            float radians = angle * static_cast<float>(M_PI / 180.0);
+            return {std::sin(radians), std::cos(radians)};
+        }
+        Rotation Inverse() const { return {-sin, cos}; }
+        bool Identity() const { return sin == 0.0f && cos == 1.0f; }
+    };
+    constexpr Rotation IDENTITY = {0.0f, 1.0f};
+
+    struct Point {
+        float x;
+        float y;
+    };
+
+    // Corner order matches the batch's unit quad: top right, bottom right,
+    // bottom left, top left. A negative half_w mirrors the quad like flip_x.
+    inline void Corners(float x, float y, float half_w, float half_h, Point out[4]) {
+        out[0] = {x + half_w, y + half_h};
+        out[1] = {x + half_w, y - half_h};
+        out[2] = {x - half_w, y - half_h};
+        out[3] = {x - half_w, y + half_h};
+    }
+
+    inline void Corners(float x, float y, float half_w, float half_h, Rotation rotation, Point out[4]) {
+        // Rotated half extents, the other two corners are their mirror images
+        float ax = rotation.cos * half_w - rotation.sin * half_h;
+        float ay = rotation.sin * half_w + rotation.cos * half_h;
+        float bx = rotation.cos * half_w + rotation.sin * half_h;
+        float by = rotation.sin * half_w - rotation.cos * half_h;
+        out[0] = {x + ax, y + ay};
+        out[1] = {x + bx, y + by};
+        out[2] = {x - ax, y - ay};
+        out[3] = {x - bx, y - by};
+    }
+}
+
+#endif // QUAD_TRANSFORM_HPP
@@ -16,6 +16,10 @@ namespace Settings {
     const unsigned int SCR_HEIGHT = 900;
     constexpr float GRAVITYPX = GRAVITY * SCR_HEIGHT;  // px/s^2
     constexpr float EPSILON = 1e-4f;
+    constexpr float TICK_RATE = 120.0f; // simulation steps per second
+    constexpr float WORLD_WIDTH = 8.0f * SCR_WIDTH; // px, the generated tile map's width
+    constexpr float CLOUD_PARALLAX = 0.3f; // clouds scroll at this fraction of the camera's speed
+    constexpr float MAX_FRAME_TIME = 0.25f; // longer frames are simulated as this, so a stall can't snowball
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef SHADER_PROGRAM_HPP
+#define SHADER_PROGRAM_HPP
+
+#include <iostream>
+#include <string>
+#include <map>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+
+// Wraps a linked program. Active uniforms and attributes are reflected once,
+// callers keep the returned handles so the frame loop never looks up strings.
+class ShaderProgram {
+public:
+    template <typename T>
+    struct Uniform {
+        int location = -1;
+    };
+
+    struct Attribute {
+        int location = -1;
+        GLenum type = 0;
+    };
+
+    explicit ShaderProgram(unsigned int program);
+    ~ShaderProgram();
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    unsigned int Id() const { return id; }
+    void Use() const;
+
+    // Logs and returns an inert handle (location -1) if the name isn't an
+    // active uniform of the expected type.
+    template <typename T>
+    Uniform<T> GetUniform(const string& name) const {
+        Uniform<T> handle;
+        auto it = uniforms.find(name);
+        if (it == uniforms.end()) {
+            cerr << "Shader uniform not found: " << name << "\n";
+            return handle;
+        }
+        if (!TypeMatches<T>(it->second.type)) {
+            cerr << "Shader uniform type mismatch: " << name << "\n";
+            return handle;
+        }
+        handle.location = it->second.location;
+        return handle;
+    }
+    Attribute GetAttribute(const string& name) const;
+
+    // The program must be in use.
+    void Set(Uniform<int> uniform, int value) const { glUniform1i(uniform.location, value); }
+    void Set(Uniform<float> uniform, float value) const { glUniform1f(uniform.location, value); }
+    void Set(Uniform<glm::vec2> uniform, const glm::vec2& value) const { glUniform2f(uniform.location, value.x, value.y); }
+    void Set(Uniform<glm::vec4> uniform, const glm::vec4& value) const { glUniform4f(uniform.location, value.x, value.y, value.z, value.w); }
+    void Set(Uniform<glm::mat4> uniform, const glm::mat4& value) const {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+private:
+    struct Reflected {
+        int location;
+        GLenum type;
+    };
+
+    template <typename T>
+    static bool TypeMatches(GLenum type);
+
+    unsigned int id;
+    map<string, Reflected> uniforms;
+    map<string, Attribute> attributes;
+};
+
+template <> inline bool ShaderProgram::TypeMatches<int>(GLenum type) {
+    return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D;
+}
+template <> inline bool ShaderProgram::TypeMatches<float>(GLenum type) { return type == GL_FLOAT; }
+template <> inline bool ShaderProgram::TypeMatches<glm::vec2>(GLenum type) { return type == GL_FLOAT_VEC2; }
+template <> inline bool ShaderProgram::TypeMatches<glm::vec4>(GLenum type) { return type == GL_FLOAT_VEC4; }
+template <> inline bool ShaderProgram::TypeMatches<glm::mat4>(GLenum type) { return type == GL_FLOAT_MAT4; }
+
+#endif // SHADER_PROGRAM_HPP
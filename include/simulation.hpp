@@ -0,0 +1,110 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include <character.hpp>
+#include <crowd.hpp>
+#include <triple_buffer.hpp>
+#include <input_log.hpp>
+#include <state_hash.hpp>
+#include <settings.hpp>
+
+using namespace std;
+
+// Everything the renderer needs for one tick. The previous tick rides along
+// so a snapshot alone is enough to interpolate.
+struct FrameSnapshot {
+    Character::Pose player_previous;
+    Character::Pose player_current;
+    Crowd::Poses crowd_previous;
+    Crowd::Poses crowd_current;
+    double tick_time = 0.0; // Simulation::Now() the current tick stands for
+    unsigned long tick = 0;
+};
+
+// Steps the player and the crowd at a fixed tick rate and hands the results
+// to the renderer through a triple buffer, so neither side waits on the other.
+// Runs on its own thread after Start(), or is driven by Advance() from the
+// render loop otherwise.
+class Simulation {
+public:
+    // Written by the input thread, read once per tick
+    struct Input {
+        atomic<bool> move_left{false};
+        atomic<bool> move_right{false};
+        atomic<bool> sprint{false};
+        atomic<bool> jump{false}; // set on the press edge, consumed by the next tick
+    };
+
+    Simulation(Character& player, Crowd& crowd, float tick_dt);
+    ~Simulation();
+
+    void Start();
+    void Stop();
+
+    // Runs every tick due by now. Frames longer than MAX_FRAME_TIME are
+    // simulated as MAX_FRAME_TIME so a stall can't snowball.
+    void Advance(double now);
+    // Seconds since construction
+    double Now() const;
+
+    // Render side: the newest published snapshot, and how far to interpolate
+    // into it. Rendering runs one tick behind so alpha stays within [0, 1].
+    const FrameSnapshot& Latest();
+    float Alpha(const FrameSnapshot& snapshot, double now) const;
+
+    float TickDt() const { return tick_dt; }
+    // Wall clock cost of the most recent tick
+    float LastTickMs() const { return last_tick_ms.load(memory_order_relaxed); }
+
+    Input input;
+    // Crowd collisions each tick, and the player against the crowd, with
+    // overlapping members pushed apart. Set before Start.
+    bool collide = true;
+
+    // Also set before Start. Every tick's input is appended to record, or
+    // taken from replay instead of input. Once replay runs out ticks stop
+    // stepping anything.
+    InputLog* record = nullptr;
+    const InputLog* replay = nullptr;
+    bool ReplayDone() const { return replay_done.load(memory_order_acquire); }
+
+    // Hash the state after every tick (turned on by record and replay) and
+    // stream each tick's hash to hash_log if set. Set before Start.
+    bool hash = false;
+    StateHash::Log* hash_log = nullptr;
+
+    // The player's and every crowd member's hash, current state only
+    uint64_t CurrentHash() const;
+    // Every tick's CurrentHash chained, one value standing for the whole run
+    // so far. Simulation thread, or after Stop or ReplayDone.
+    uint64_t RunHash() const { return run_hash; }
+    unsigned long Ticks() const { return ticks; }
+
+private:
+    void Tick();
+    void Run();
+
+    Character& player;
+    Crowd& crowd;
+    const float tick_dt;
+    const chrono::steady_clock::time_point epoch;
+
+    // Simulation thread only
+    double next_tick;
+    unsigned long ticks;
+    Character::Pose player_last;
+    Crowd::Poses crowd_last;
+
+    TripleBuffer<FrameSnapshot> snapshots;
+    thread worker;
+    atomic<bool> running;
+    atomic<float> last_tick_ms;
+    atomic<bool> replay_done;
+    uint64_t run_hash;
+};
+
+#endif // SIMULATION_HPP
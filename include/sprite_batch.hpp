@@ -0,0 +1,124 @@
+#ifndef SPRITE_BATCH_HPP
+#define SPRITE_BATCH_HPP
+
+#include <vector>
+#include <array>
+#include <deque>
+
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <gl_util.hpp>
+#include <quad_transform.hpp>
+
+using namespace std;
+
+// Draw order, lowest first. Sprites in the same layer are grouped by texture,
+// so only sprites that never overlap each other should share a layer.
+namespace Layers {
+    enum LayerEnums {
+        Background = 0,
+        Clouds = 10,
+        Ground = 20,
+        Floor = 30,
+        GroundShadow = 31,
+        Crowd = 35,
+        Character = 40, // Character + body part draw order
+        Hud = 90,
+        Mouse = 100,
+    };
+}
+
+// Draw only records each quad and a small sort key. End sorts the keys and
+// works out each quad's corners straight into a ring of vertex buffer ranges
+// mapped unsynchronized, so vertices are written once and never copied. A
+// fence per End() guards each range until the GPU is done with it, so
+// writing never waits on the driver unless the ring wraps onto draws still
+// in flight.
+class SpriteBatch {
+public:
+    SpriteBatch(const ShaderProgram& shader, size_t initial_sprites = 1024);
+    ~SpriteBatch();
+
+    void Begin();
+    void Draw(
+        const Textures::Region& region,
+        int layer,
+        float x,
+        float y,
+        float width,
+        float height,
+        float angle,
+        bool flip_x
+    );
+    // Same, with the sin/cos already worked out, e.g. shared by several limbs
+    void Draw(
+        const Textures::Region& region,
+        int layer,
+        float x,
+        float y,
+        float width,
+        float height,
+        QuadTransform::Rotation rotation,
+        bool flip_x
+    );
+    void End();
+
+    // Sprites that can't reach into [x0, x1] x [y0, y1] are dropped in Draw
+    // before their corners are worked out. Stays set across Begin/End.
+    void SetView(float x0, float y0, float x1, float y1);
+    void ClearView();
+
+    // Times End() had to wait for the GPU to release ring space
+    size_t Stalls() const { return stalls; }
+
+private:
+    struct Vertex {
+        float x, y, z;
+        float u, v;
+    };
+
+    // Everything End needs to write a sprite's four vertices
+    struct Quad {
+        float x, y;
+        float half_w, half_h; // negative half_w mirrors
+        QuadTransform::Rotation rotation;
+        Textures::UVRect uv;
+    };
+
+    // What End sorts instead of the quads themselves
+    struct Key {
+        int layer;
+        unsigned int texture;
+        unsigned int index; // into quads, keeps submission order among equals
+    };
+
+    // A range of the ring the GPU may still be reading
+    struct Fence {
+        GLsync sync;
+        size_t begin, end;
+    };
+
+    // Ends worth of the largest batch the ring holds before wrapping
+    static constexpr size_t RING_BATCHES = 8;
+
+    void Reserve(size_t n_sprites);
+    void ReleaseFences();
+
+    vector<Quad> quads;
+    vector<Key> keys;
+
+    const ShaderProgram& shader;
+    GlShaders::SpriteUniforms uniforms;
+
+    size_t capacity;
+    size_t ring_bytes;
+    size_t head;
+    deque<Fence> fences;
+    size_t stalls;
+    bool cull;
+    float view_x0, view_y0, view_x1, view_y1;
+    unsigned int VAO, VBO, EBO;
+};
+
+#endif // SPRITE_BATCH_HPP
@@ -0,0 +1,69 @@
+#ifndef STATE_HASH_HPP
+#define STATE_HASH_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+// Bit exact fingerprints of simulation state for catching drift after an
+// optimization. Word-wise FNV-1a, one multiply per 32-bit field, so hashing
+// every character every tick stays cheap. Floats are hashed by their bits,
+// so any difference at all shows, -0.0 against 0.0 included.
+namespace StateHash {
+    constexpr uint64_t OFFSET = 14695981039346656037ull;
+
+    inline uint64_t Mix(uint64_t hash, uint32_t word) {
+        return (hash ^ word) * 1099511628211ull;
+    }
+    inline uint64_t Mix(uint64_t hash, float value) {
+        uint32_t word;
+        memcpy(&word, &value, sizeof(word));
+        return Mix(hash, word);
+    }
+    inline uint64_t Mix(uint64_t hash, uint64_t value) {
+        return Mix(Mix(hash, static_cast<uint32_t>(value)), static_cast<uint32_t>(value >> 32));
+    }
+
+    // Streams one (tick, hash) record per tick to a file
+    class Log {
+    public:
+        // Throws if the file can't be created
+        explicit Log(const string& path);
+        ~Log();
+        Log(const Log&) = delete;
+        Log& operator=(const Log&) = delete;
+
+        // Stops writing after the first failure, which Close reports
+        void Write(unsigned long tick, uint64_t hash);
+        // Throws if any write failed, so a short log is never taken for a
+        // run that stopped early
+        void Close();
+
+    private:
+        string path;
+        FILE* file;
+        bool failed = false;
+    };
+
+    struct Comparison {
+        unsigned long compared; // ticks both logs have
+        bool diverged;
+        unsigned long tick;     // first diverging tick
+        uint64_t hash_a, hash_b;
+        unsigned long length_a, length_b;
+    };
+    // Walks two logs in step up to the first tick their hashes differ. Throws
+    // if either isn't a hash log or their ticks don't line up.
+    Comparison Compare(const string& path_a, const string& path_b);
+    // --compare-hashes, Compare printed. Nonzero if the runs diverge or one
+    // stops short of the other.
+    int Report(const string& path_a, const string& path_b);
+
+    // 16 hex digits
+    string Hex(uint64_t hash);
+}
+
+#endif // STATE_HASH_HPP
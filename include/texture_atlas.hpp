@@ -0,0 +1,47 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <glad/glad.h>
+
+#include <gl_util.hpp>
+#include <asset_loader.hpp>
+
+using namespace std;
+
+// Packs small PNGs into a few shared GL textures at startup so that sprites
+// using any of them can be drawn without rebinding.
+class TextureAtlas {
+public:
+    TextureAtlas(int page_size = 2048, int padding = 4);
+    ~TextureAtlas();
+
+    // Queue an image for packing. Returns false if it is too large for a page
+    // and should be loaded as its own texture instead.
+    bool Add(const Image& image);
+    bool Add(const string& path) { return Add(DecodeImage(path)); }
+    void Build();
+
+    bool Contains(const string& path) const;
+    Textures::Region Find(const string& path) const;
+    size_t Pages() const { return pages.size(); }
+
+private:
+    struct Entry {
+        Image image;
+        int page, x, y;
+    };
+
+    int page_size;
+    int padding;
+    bool built;
+
+    vector<Entry> entries;
+    vector<unsigned int> pages;
+    map<string, Textures::Region> regions;
+};
+
+#endif // TEXTURE_ATLAS_HPP
@@ -0,0 +1,25 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include <string>
+#include <atomic>
+
+#include <asset_loader.hpp>
+
+using namespace std;
+
+// On-disk cache of decoded, premultiplied RGBA8 images so warm starts skip
+// PNG decoding. An entry is keyed by the source path and is stale as soon as
+// the source's mtime or size differ from what was recorded.
+namespace TextureCache {
+    extern bool enabled;
+    extern string directory;
+    extern atomic<int> hits;
+
+    // Maps the cached pixels straight into image.pixels. False if missing or stale.
+    bool Load(const string& path, Image& image);
+    // Best effort, failures only mean the next run decodes again
+    void Store(const string& path, const Image& image);
+}
+
+#endif // TEXTURE_CACHE_HPP
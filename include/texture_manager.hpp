@@ -0,0 +1,58 @@
+#ifndef TEXTURE_MANAGER_HPP
+#define TEXTURE_MANAGER_HPP
+
+#include <string>
+#include <map>
+#include <memory>
+
+#include <glad/glad.h>
+
+#include <gl_util.hpp>
+#include <asset_loader.hpp>
+#include <texture_atlas.hpp>
+
+using namespace std;
+
+// Shared reference to an interned texture. Copies are cheap and never upload.
+using TextureHandle = shared_ptr<const Textures::Region>;
+
+// Interns textures by path. Every Acquire of the same path returns the same
+// handle, so N characters cost the same texture memory and uploads as one.
+// Small images share atlas pages, larger ones get their own texture which is
+// deleted when its last handle goes away. GL thread only, and handles must
+// not outlive the manager.
+class TextureManager {
+public:
+    TextureManager() = default;
+    ~TextureManager();
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // Preloads a decoded image, e.g. from AssetLoader::Poll. Duplicates are ignored.
+    void Add(const Image& image);
+    // Packs the atlas, must happen before the first Acquire
+    void Build();
+
+    // Paths that weren't preloaded are decoded and uploaded on the spot.
+    TextureHandle Acquire(const string& path);
+
+    // Textures currently held by at least one handle
+    size_t Live() const;
+    size_t Uploads() const { return uploads; }
+
+private:
+    struct Entry {
+        Textures::Region region;
+        bool standalone;
+        weak_ptr<const Textures::Region> handle;
+    };
+
+    void Release(const string& path, const Textures::Region* region);
+
+    TextureAtlas atlas;
+    map<string, Entry> entries;
+    size_t uploads = 0;
+    bool built = false;
+};
+
+#endif // TEXTURE_MANAGER_HPP
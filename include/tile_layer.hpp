@@ -0,0 +1,44 @@
+#ifndef TILE_LAYER_HPP
+#define TILE_LAYER_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <gl_util.hpp>
+#include <shader_program.hpp>
+#include <sprite_batch.hpp>
+
+using namespace std;
+
+// A static set of unrotated tiles drawn with one instanced call through the
+// program from GlShaders::CreateTileShaderProgram. Instances are uploaded once
+// per Build, not per frame.
+class TileLayer {
+public:
+    struct Instance {
+        float x, y;          // center
+        float w, h;
+        Textures::UVRect uv;
+    };
+
+    TileLayer();
+    ~TileLayer();
+
+    // Every tile must come from the same texture or atlas page
+    void Build(const vector<Instance>& tiles, unsigned int texture);
+    void Draw() const;
+
+    // Fallback for the non-instanced path, one batched sprite per tile
+    void Submit(SpriteBatch& batch, int layer) const;
+
+    size_t Size() const { return instances.size(); }
+
+private:
+    vector<Instance> instances;
+    unsigned int texture;
+    size_t capacity;
+    unsigned int VAO, quad_VBO, EBO, instance_VBO;
+};
+
+#endif // TILE_LAYER_HPP
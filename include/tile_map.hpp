@@ -0,0 +1,65 @@
+#ifndef TILE_MAP_HPP
+#define TILE_MAP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// World tiles as layers of tile ids stored in fixed-size square chunks, each
+// chunk contiguous so it can be built into a vertex buffer on its own. Id 0 is
+// empty, any other id draws the layer's texture. Saved maps are the header
+// and the ids as they sit in memory, so Load just maps the file.
+class TileMap {
+public:
+    static constexpr int CHUNK_SIZE = 32; // tiles per chunk side
+
+    struct Layer {
+        int texture;      // Textures::TextureEnums
+        int sprite_layer; // Layers::LayerEnums, for the batched path
+        float tile_size;
+        float origin_x, origin_y; // center of tile (0, 0)
+        int chunks_x, chunks_y;
+    };
+
+    // Chunk coordinates, [x0, x1) x [y0, y1)
+    struct ChunkRange {
+        int x0, y0, x1, y1;
+    };
+
+    TileMap() = default;
+    // All tiles empty
+    explicit TileMap(const vector<Layer>& layers);
+
+    // The flat ground the scene always had, ground tiles with the floor and
+    // its shadow on top, width pixels wide
+    static TileMap Generate(float width);
+    // Throws if the file is missing or not a tile map
+    static TileMap Load(const string& path);
+    void Save(const string& path) const;
+
+    size_t LayerCount() const { return layers.size(); }
+    const Layer& GetLayer(size_t layer) const { return layers[layer]; }
+
+    // Tile coordinates outside the layer read as empty
+    uint16_t Get(size_t layer, int x, int y) const;
+    void Set(size_t layer, int x, int y, uint16_t id);
+    // CHUNK_SIZE rows of CHUNK_SIZE ids, bottom row first
+    const uint16_t* Chunk(size_t layer, int chunk_x, int chunk_y) const;
+
+    // Chunks of layer with a tile overlapping the world rect, clamped to the layer
+    ChunkRange Overlapping(size_t layer, float x0, float y0, float x1, float y1) const;
+
+private:
+    static constexpr size_t CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+
+    vector<Layer> layers;
+    vector<size_t> offsets; // first id of each layer in tiles
+    size_t n_tiles = 0;
+    // Owned by a vector for built maps or a private mapping for loaded ones
+    shared_ptr<uint16_t> tiles;
+};
+
+#endif // TILE_MAP_HPP
@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+// Lock-free single producer / single consumer handoff of the latest value.
+// The writer fills Back() and publishes it, the reader picks up the newest
+// published slot with Update(). Neither side ever waits on the other; values
+// the reader was too slow to see are simply overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& Back() { return slots[back]; }
+    void Publish() {
+        back = middle.exchange(back | FRESH, memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side. True if a newer value than the current Front() was taken.
+    bool Update() {
+        if (!(middle.load(memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& Front() const { return slots[front]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    array<T, 3> slots;
+    // Index of the slot in the middle, plus FRESH when the reader hasn't taken it yet
+    alignas(64) atomic<uint8_t> middle{1};
+    alignas(64) uint8_t back = 0;
+    alignas(64) uint8_t front = 2;
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -1,13 +1,38 @@
 #include <iostream>
 #include <map>
+#include <memory>
+#include <set>
+#include <thread>
 #include <random>
 #include <chrono>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
 
 #include <character.hpp>
+#include <crowd.hpp>
+#include <simulation.hpp>
 #include <gl_util.hpp>
+#include <shader_program.hpp>
+#include <sprite_batch.hpp>
+#include <texture_manager.hpp>
+#include <asset_loader.hpp>
+#include <texture_cache.hpp>
+#include <tile_map.hpp>
+#include <camera.hpp>
+#include <input_log.hpp>
+#include <state_hash.hpp>
+#include <chunk_cache.hpp>
+#include <layer_cache.hpp>
+#include <gpu_timer.hpp>
+#include <bench.hpp>
+#include <profiler.hpp>
+#include <headless.hpp>
+#include <hud.hpp>
+#include <animation.hpp>
+#include <collision.hpp>
 #include <settings.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -17,97 +42,374 @@ using namespace std;
 // TODO: Find why this conflicts with Screen
 int window_w, window_h;
 
-void ArgParse(int argc, char* argv[], bool& debug_mode) {
+struct Options {
+    bool debug_mode = false;
+    bool instancing = true;
+    bool layer_cache = true;
+    bool serial_load = false;
+    bool texture_cache = true;
+    bool bench_tiles = false;
+    size_t crowd = 0;
+    bool simd = true;
+    bool bench_physics = false;
+    bool bench_transform = false;
+    bool pose_tables = false;
+    bool bench_animation = false;
+    bool collision = true;
+    bool bench_collision = false;
+    string world_path;
+    string save_world_path;
+    string record_path;
+    string replay_path;
+    string hash_log_path;
+    string compare_a, compare_b;
+    float tick_rate = Settings::TICK_RATE;
+    bool sim_thread = true;
+#ifdef CHARACTER_HEADLESS_DEFAULT
+    bool headless = true;
+#else
+    bool headless = false;
+#endif
+    int frames = 600;
+    string dump_path;
+    bool profile = false;
+    string trace_path;
+    bool hud = false;
+};
+
+void ArgParse(int argc, char* argv[], Options& options) {
     for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
         if (arg == "-d" || arg == "--debug") {
-            debug_mode = true;
+            options.debug_mode = true;
             cout << "Debug mode activated\n";
+        } else if (arg == "--no-instancing") {
+            options.instancing = false;
+        } else if (arg == "--no-layer-cache") {
+            options.layer_cache = false;
+        } else if (arg == "--serial-load") {
+            options.serial_load = true;
+        } else if (arg == "--no-texture-cache") {
+            options.texture_cache = false;
+        } else if (arg == "--bench-tiles") {
+            options.bench_tiles = true;
+        } else if (arg == "--no-simd") {
+            options.simd = false;
+        } else if (arg == "--bench-physics") {
+            options.bench_physics = true;
+        } else if (arg == "--bench-transform") {
+            options.bench_transform = true;
+        } else if (arg == "--pose-tables") {
+            options.pose_tables = true;
+        } else if (arg == "--bench-animation") {
+            options.bench_animation = true;
+        } else if (arg == "--no-collision") {
+            options.collision = false;
+        } else if (arg == "--world" && i + 1 < argc) {
+            options.world_path = argv[++i];
+        } else if (arg == "--save-world" && i + 1 < argc) {
+            options.save_world_path = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            options.record_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            options.replay_path = argv[++i];
+        } else if (arg == "--hash-log" && i + 1 < argc) {
+            options.hash_log_path = argv[++i];
+        } else if (arg == "--compare-hashes" && i + 2 < argc) {
+            options.compare_a = argv[++i];
+            options.compare_b = argv[++i];
+        } else if (arg == "--bench-collision") {
+            options.bench_collision = true;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            options.frames = stoi(argv[++i]);
+        } else if (arg == "--dump" && i + 1 < argc) {
+            options.dump_path = argv[++i];
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.profile = true;
+            options.trace_path = argv[++i];
+        } else if (arg == "--hud") {
+            options.hud = true;
+        } else if (arg == "--no-sim-thread") {
+            options.sim_thread = false;
+        } else if (arg == "--tick-rate" && i + 1 < argc) {
+            options.tick_rate = stof(argv[++i]);
+            if (options.tick_rate <= 0.0f) throw runtime_error("--tick-rate must be positive");
+        } else if (arg == "--crowd" && i + 1 < argc) {
+            options.crowd = stoul(argv[++i]);
+        }
+    }
+}
+
+// Input for --headless, a fixed 4 second loop at 60 frames per second:
+// walk right, walk left and sprint, stand still. Jumps once a second.
+void ScriptedInput(int frame) {
+    int cycle = frame % 240;
+    Keys::move_right = cycle < 90;
+    Keys::move_left = cycle >= 90 && cycle < 180;
+    Keys::sprint_pressed = cycle >= 135 && cycle < 180;
+    Keys::jump_pressed = frame % 60 < 3;
+}
+
+void WritePPM(const string& path, const vector<unsigned char>& rgba, int width, int height) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) throw runtime_error("Failed to open " + path);
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    // GL rows are bottom first
+    for (int y = height - 1; y >= 0; y--) {
+        for (int x = 0; x < width; x++) {
+            fwrite(&rgba[(static_cast<size_t>(y) * width + x) * 4], 1, 3, file);
         }
     }
+    fclose(file);
 }
 
 int main(int argc, char* argv[]) {
-    bool debug_mode = false;
-    ArgParse(argc, argv, debug_mode);
+    auto start_time = chrono::steady_clock::now();
+    Options options;
+    ArgParse(argc, argv, options);
+    Profiler::enabled = options.profile;
+    Profiler::SetThreadName("main");
+    if (options.bench_transform) {
+        Bench::SpriteCorners();
+        return 0;
+    }
+    if (options.bench_collision) {
+        Bench::CollisionPairs();
+        return 0;
+    }
+    if (!options.compare_a.empty()) {
+        return StateHash::Report(options.compare_a, options.compare_b);
+    }
+    TileMap world = options.world_path.empty() ? TileMap::Generate(Settings::WORLD_WIDTH) : TileMap::Load(options.world_path);
+    if (!options.save_world_path.empty()) {
+        world.Save(options.save_world_path);
+        cout << "Wrote " << options.save_world_path << "\n";
+        return 0;
+    }
+    // Bake now rather than on the first rendered frame
+    Animation::use_tables = options.pose_tables;
+    if (Animation::use_tables) {
+        Animation::WalkTable();
+        Animation::Rotations();
+    }
 
     auto seed = std::chrono::steady_clock::now().time_since_epoch().count();
     std::mt19937 rng(seed);
 
-    if (!glfwInit()) throw runtime_error("Failed to initialize GLFW");
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // A replay runs with whatever the recording ran with
+    InputLog record, replay;
+    uint32_t crowd_seed = static_cast<uint32_t>(seed);
+    if (!options.replay_path.empty()) {
+        replay = InputLog::Load(options.replay_path);
+        options.tick_rate = replay.tick_rate;
+        options.crowd = replay.crowd;
+        crowd_seed = replay.seed;
+    }
+    record.tick_rate = options.tick_rate;
+    record.crowd = static_cast<uint32_t>(options.crowd);
+    record.seed = crowd_seed;
+
+    // Headless renders into an FBO on an EGL context, there is no window at all
+    GLFWwindow* window = nullptr;
+    unique_ptr<HeadlessContext> headless;
+    if (options.headless) {
+        headless = make_unique<HeadlessContext>();
+        if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::ProcAddress)) throw runtime_error("Failed to initialize GLAD");
+        headless->CreateFramebuffer(Screen::w, Screen::h);
+        window_w = Screen::w;
+        window_h = Screen::h;
+    } else {
+        if (!glfwInit()) throw runtime_error("Failed to initialize GLFW");
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+        window = glfwCreateWindow(Screen::w, Screen::h, "Goblin Slayer", NULL, NULL);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window\n";
+            glfwTerminate();
+            return -1;
+        }
+        glfwSwapInterval(Screen::vsync);
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, GlCallback::FramebufferSizeCallback);
 
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) throw runtime_error("Failed to initialize GLAD");
 
-    GLFWwindow* window = glfwCreateWindow(Screen::w, Screen::h, "Goblin Slayer", NULL, NULL);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate();
-        return -1;
+        glfwSetCursorPosCallback(window, GlCallback::MousePositionCallback);
+        glfwSetMouseButtonCallback(window, GlCallback::MouseButtonCallback);
     }
-    glfwSwapInterval(Screen::vsync);
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, GlCallback::FramebufferSizeCallback);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) throw runtime_error("Failed to initialize GLAD");
+    ShaderProgram shader(GlShaders::CreateShaderProgram());
+    GlShaders::SpriteUniforms sprite_uniforms(shader);
 
-    unsigned int shader_program = GlShaders::CreateShaderProgram();
-    if (shader_program == 0) throw runtime_error("Failed to create shader program");
+    SpriteBatch batch(shader);
 
-    float vertices[] = {
-        // positions        // texture coords
-         0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // Top Right
-         0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // Bottom Right
-        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // Bottom Left
-        -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // Top Left
-    };
-    unsigned int indices[] = {
-        0, 1, 3,  // First Triangle
-        1, 2, 3   // Second Triangle
-    };
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO); 
-    glGenBuffers(1, &VBO); 
-    glGenBuffers(1, &EBO); 
-
-    glBindVertexArray(VAO); 
+    shader.Use();
+    shader.Set(sprite_uniforms.texture1, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO); 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW); 
+    // Textures are premultiplied, see DecodeImage
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    ShaderProgram tile_shader(GlShaders::CreateTileShaderProgram());
+    ShaderProgram::Uniform<glm::mat4> tile_projection = tile_shader.GetUniform<glm::mat4>("projection");
+    tile_shader.Use();
+    tile_shader.Set(tile_shader.GetUniform<int>("texture1"), 0);
+
+    // Screen space unless given the camera's
+    auto set_projection = [&](const glm::mat4& projection = glm::ortho(0.0f, (float)Screen::w, 0.0f, (float)Screen::h)) {
+        shader.Use();
+        shader.Set(sprite_uniforms.projection, projection);
+        tile_shader.Use();
+        tile_shader.Set(tile_projection, projection);
+    };
+    set_projection();
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO); 
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW); 
+    TextureCache::enabled = options.texture_cache;
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0); 
-    glEnableVertexAttribArray(0); 
+    set<string> asset_paths = {"pngs/sword_32_32.png"};
+    for (auto& path : Character::TexturePaths(Goblin)) {
+        asset_paths.insert(path);
+    }
+    for (auto& load : Textures::TextureLoads) {
+        asset_paths.insert(load.second.texture_path);
+    }
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float))); 
-    glEnableVertexAttribArray(1); 
+    auto decode_start = chrono::steady_clock::now();
+    TextureCache::hits = 0;
+    AssetLoader loader(options.serial_load ? 0 : thread::hardware_concurrency());
+    // The loading screen is queued first so it's up early, but it decodes
+    // alongside everything else instead of holding the workers back
+    const string loading_path = "pngs/loading_1440_900.png";
+    loader.Queue(loading_path);
+    for (auto& path : asset_paths) {
+        loader.Queue(path);
+    }
 
-    glfwSetCursorPosCallback(window, GlCallback::MousePositionCallback);
-    glfwSetMouseButtonCallback(window, GlCallback::MouseButtonCallback);
+    // Everything small enough shares atlas pages, the rest gets its own texture.
+    // Uploads happen here on the GL thread as the workers finish.
+    TextureManager texture_manager;
+    Textures::Region loading_screen = {0, Textures::FULL_UV};
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    while (true) {
+        for (Image& image : loader.Poll()) {
+            if (image.path != loading_path) {
+                texture_manager.Add(image);
+                continue;
+            }
+            loading_screen.texture = UploadTexture(image);
+            glClear(GL_COLOR_BUFFER_BIT);
+            batch.Begin();
+            batch.Draw(loading_screen, Layers::Background, Screen::w / 2.0f, Screen::h / 2.0f, Screen::w, Screen::h, 0.0f, false);
+            batch.End();
+            if (window) glfwSwapBuffers(window);
+        }
+        if (loader.Done()) break;
 
-    Character goblin(Goblin, debug_mode);
+        loader.Wait(chrono::milliseconds(16));
+        if (window) glfwPollEvents();
+    }
+    texture_manager.Build();
+    glDeleteTextures(1, &loading_screen.texture);
+    cout << "Decoded " << asset_paths.size() + 1 << " images (" << TextureCache::hits << " cached) in "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - decode_start).count() << " ms\n";
+
+    Character goblin(Goblin, texture_manager, options.debug_mode);
+    // The handles keep the scene textures resident for the whole run
+    vector<TextureHandle> scene_handles;
     vector<Textures::Texture> textures;
     for (int i = 0; i < Textures::N_Textures; i++) {
-        textures.push_back({ 
-            LoadTexture(Textures::TextureLoads.find(i)->second.texture_path.c_str()),
-            Textures::TextureLoads.find(i)->second.dim
-        });
+        const Textures::TextureConfig& config = Textures::TextureLoads.find(i)->second;
+        scene_handles.push_back(texture_manager.Acquire(config.texture_path));
+        textures.push_back({*scene_handles.back(), config.dim});
+    }
+    scene_handles.push_back(texture_manager.Acquire("pngs/sword_32_32.png"));
+    Mouse::texture = *scene_handles.back();
+    if (options.bench_physics) {
+        Bench::CrowdPhysics(goblin);
+        glfwTerminate();
+        return 0;
+    }
+    if (options.bench_animation) {
+        Bench::WalkPoses(goblin, batch);
+        glfwTerminate();
+        return 0;
     }
-    Mouse::texture = LoadTexture("pngs/sword_32_32.png");
 
-    glUseProgram(shader_program);
-    glUniform1i(glGetUniformLocation(shader_program, "texture1"), 0);
+    // Outlives the simulation thread writing to it
+    unique_ptr<StateHash::Log> hash_log;
+    if (!options.hash_log_path.empty()) hash_log = make_unique<StateHash::Log>(options.hash_log_path);
+    Crowd crowd(goblin, options.crowd, crowd_seed);
+    crowd.simd = options.simd;
+    Simulation simulation(goblin, crowd, 1.0f / options.tick_rate);
+    simulation.collide = options.collision;
+    if (!options.record_path.empty()) simulation.record = &record;
+    if (!options.replay_path.empty()) simulation.replay = &replay;
+    if (hash_log) simulation.hash_log = hash_log.get();
+    simulation.hash = simulation.record || simulation.replay || simulation.hash_log;
+
+    // Saves the recording, checks a replay against the hash it recorded and
+    // closes the hash log last, so a failed side log can't cost the other
+    // two. Nonzero if the replay diverged or the hash log couldn't be written.
+    auto finish_logs = [&]() {
+        int status = 0;
+        if (!options.record_path.empty()) {
+            record.Finish(simulation.Ticks(), simulation.RunHash());
+            record.Save(options.record_path);
+            cout << "Recorded " << record.Ticks() << " ticks (" << record.Records() << " input changes) to "
+                 << options.record_path << ", state hash " << StateHash::Hex(record.StateHash()) << "\n";
+        }
+        if (!options.replay_path.empty()) {
+            if (!simulation.ReplayDone()) {
+                cout << "Replay stopped at tick " << simulation.Ticks() << " of " << replay.Ticks() << "\n";
+                status = 1;
+            } else {
+                bool match = simulation.RunHash() == replay.StateHash();
+                cout << "Replayed " << replay.Ticks() << " ticks, state hash " << StateHash::Hex(simulation.RunHash())
+                     << ", recorded " << StateHash::Hex(replay.StateHash()) << (match ? ", match" : ", MISMATCH") << "\n";
+                status = match ? 0 : 1;
+            }
+        }
+        if (hash_log) {
+            try {
+                hash_log->Close();
+            } catch (const runtime_error& e) {
+                std::cerr << e.what() << "\n";
+                status = 1;
+            }
+        }
+        return status;
+    };
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cout << "Textures: " << texture_manager.Live() << " in use, " << texture_manager.Uploads() << " uploads\n";
 
-    glm::mat4 projection = glm::ortho(0.0f, (float)Screen::w, 0.0f, (float)Screen::h);
-    glUniformMatrix4fv(glGetUniformLocation(shader_program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    vector<Textures::Texture> world_textures;
+    for (size_t layer = 0; layer < world.LayerCount(); layer++) {
+        world_textures.push_back(textures[world.GetLayer(layer).texture]);
+    }
+    ChunkCache chunks(world, world_textures);
+    unsigned int view_w = 0, view_h = 0;
+
+    Camera camera;
+    // With the layer cache on, the tiles are baked two screens wide (or as
+    // wide as the GPU allows) around the camera and only rebaked once it
+    // scrolls out of them
+    Camera baked;
+
+    LayerCache static_layer;
+    int max_texture_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+    GpuTimer gpu_timer;
+    Hud hud;
+    hud.visible = options.hud;
 
     uniform_int_distribution<int> dist(1, 6);
     int n_clouds = dist(rng);
@@ -116,7 +418,8 @@ int main(int argc, char* argv[]) {
     vector<pair<float, float>> clouds_size;
     for (int i = 0; i < n_clouds; i++) {
         uniform_int_distribution<int> x_cloud(1, static_cast<int>(Screen::w - textures[Textures::Clouds].dim.w));
-        uniform_int_distribution<int> y_cloud(1, static_cast<int>(Screen::h - textures[Textures::Clouds].dim.h));
+        // Kept above the ground
+        uniform_int_distribution<int> y_cloud(static_cast<int>(Settings::MAX_GROUND_Y), static_cast<int>(Screen::h - textures[Textures::Clouds].dim.h));
         cloud_pos.push_back({static_cast<float>(x_cloud(rng)), static_cast<float>(y_cloud(rng))});
 
         uniform_int_distribution<int> w_cloud(56*2, 56*4); 
@@ -124,93 +427,153 @@ int main(int argc, char* argv[]) {
         clouds_size.push_back({h_cloud, h_cloud * 0.64286f}); 
     }
     
-    FrameTracker::last_frame_time = glfwGetTime();
-
-    while (!glfwWindowShouldClose(window)) {
-        glfwGetWindowSize(window, &window_w, &window_h);
-
-        FrameTracker::current_frame_time = glfwGetTime();
-        FrameTracker::dt = FrameTracker::current_frame_time - FrameTracker::last_frame_time;
-        FrameTracker::last_frame_time = FrameTracker::current_frame_time;
-        
-        glfwPollEvents();
-        Keys::move_left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
-        Keys::move_right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
-        Keys::jump_pressed = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
-        Keys::sprint_pressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+    // Ground, floor and shadow chunks in rect. Expects batch.Begin() to have
+    // been called with the matching projection.
+    auto draw_tiles = [&](const Collision::Box& rect) {
+        // Half a screen of chunks either side is built ahead of the view
+        {
+            PROFILE_SCOPE("stream tiles");
+            chunks.Update(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, Screen::w * 0.5f);
+        }
+        if (options.instancing) {
+            batch.End();
+            Profiler::BeginGpu("tiles");
+            tile_shader.Use();
+            {
+                PROFILE_SCOPE("tiles");
+                for (size_t layer = 0; layer < world.LayerCount(); layer++) {
+                    chunks.Draw(layer);
+                }
+            }
+            Profiler::EndGpu();
+            batch.Begin();
+        } else {
+            PROFILE_SCOPE("tiles");
+            for (size_t layer = 0; layer < world.LayerCount(); layer++) {
+                chunks.Submit(batch, layer);
+            }
+        }
+    };
 
-        if (Keys::jump_pressed && !Keys::space_key_pressed_last_frame) {
-            goblin.time_since_jump_pressed = 0.0;
+    // Draws one frame of the world into the bound framebuffer
+    auto render_world = [&](const FrameSnapshot& snapshot) {
+        PROFILE_SCOPE("render");
+        RenderStats::Reset();
+
+        float player_x = snapshot.player_previous.position[0]
+            + (snapshot.player_current.position[0] - snapshot.player_previous.position[0]) * FrameTracker::alpha;
+        camera.w = static_cast<float>(Screen::w);
+        camera.h = static_cast<float>(Screen::h);
+        if (view_w != Screen::w || view_h != Screen::h) {
+            camera.Snap(player_x, Settings::WORLD_WIDTH);
+            view_w = Screen::w;
+            view_h = Screen::h;
+            static_layer.Invalidate();
+        } else {
+            camera.Follow(player_x, Settings::WORLD_WIDTH, FrameTracker::dt);
         }
-        Keys::space_key_pressed_last_frame = Keys::jump_pressed;
-        
-        goblin.Move(Keys::move_left, Keys::move_right, Keys::sprint_pressed);
-        goblin.UpdateTimes(FrameTracker::dt);
-        
-        if (goblin.time_since_jump_pressed >= 0.0) {
-            goblin.Jump();
+        Collision::Box view = camera.View();
+
+        int viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        // Minimized windows can report a 0x0 framebuffer, which no texture
+        // can be attached at. Past GL_MAX_TEXTURE_SIZE the bake is narrowed,
+        // and dropped once it couldn't cover a single screen.
+        int bake_width = min(viewport[2] * 2, max_texture_size);
+        bool cached = options.layer_cache && viewport[2] > 0 && viewport[3] > 0
+            && bake_width >= viewport[2] && viewport[3] <= max_texture_size;
+        if (cached) {
+            bool covered = camera.x >= baked.x && camera.x + camera.w <= baked.x + baked.w;
+            if (!covered || !static_layer.Valid(bake_width, viewport[3])) {
+                PROFILE_SCOPE("bake static layer");
+                Profiler::BeginGpu("bake static layer");
+                baked.w = camera.w * bake_width / viewport[2];
+                baked.h = camera.h;
+                baked.x = camera.x - (baked.w - camera.w) * 0.5f;
+                set_projection(baked.Projection());
+                static_layer.Begin(bake_width, viewport[3]);
+                batch.ClearView();
+                batch.Begin();
+                draw_tiles(baked.View());
+                batch.End();
+                static_layer.End();
+                Profiler::EndGpu();
+            }
         }
-        
-        goblin.Update(FrameTracker::dt);
 
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glUseProgram(shader_program);
-        glBindVertexArray(VAO);
-
-        glm::mat4 model = glm::mat4(1.0f);
-
-        /* 1. background   2. clouds   3. ground   4. floor   5. character   6. mouse icon */
-        // TODO(): make a general use Render fn for init renders, use this fn for Character class and background
-        // TODO: render groud, floor, and background as a texture with 1 render call. Clouds and other objects will create a parallax effect for movement indication
-        // background 
-        GlShaders::Render(model, shader_program, textures[Textures::Background].texture,
-            Screen::w / 2.0f, Screen::h / 2.0f, 
-            Screen::w, Screen::h,
-            0.0f, false
-        );
-
-        // clouds
-        for (int i = 0; i < n_clouds; i++) {
-            GlShaders::Render(model, shader_program, textures[Textures::Clouds].texture,
-                cloud_pos[i].first, cloud_pos[i].second, 
-                clouds_size[i].first, clouds_size[i].second,
+        // World pass through the camera, anything out of view is dropped
+        // before it reaches the batch or, for stray sprites, in it
+        set_projection(camera.Projection());
+        batch.SetView(view.x, view.y, view.x + view.w, view.y + view.h);
+        batch.Begin();
+
+        /* 1. background   2. clouds   3. ground, floor   4. characters */
+        {
+            PROFILE_SCOPE("background");
+            // Far enough away not to scroll at all
+            batch.Draw(textures[Textures::Background].region, Layers::Background,
+                camera.x + Screen::w / 2.0f, Screen::h / 2.0f,
+                Screen::w, Screen::h,
                 0.0f, false
             );
         }
 
-        // ground
-        for (int i = 0; i <= Screen::w / textures[Textures::Ground].dim.w; i++) {
-            for (int j = 0; j <= (Settings::MIN_GROUND_Y - textures[Textures::Ground].dim.w) / textures[Textures::Ground].dim.w; j++) {
-                GlShaders::Render(model, shader_program, textures[Textures::Ground].texture, 
-                    textures[Textures::Ground].dim.w * i, textures[Textures::Ground].dim.w * j, 
-                    textures[Textures::Ground].dim.w, textures[Textures::Ground].dim.w,
+        // clouds, scrolling at a fraction of the camera's speed and wrapping
+        // around so there are always some in view
+        {
+            PROFILE_SCOPE("clouds");
+            const float margin = 56.0f * 4.0f;
+            const float span = Screen::w + margin * 2.0f;
+            for (int i = 0; i < n_clouds; i++) {
+                float x = fmod(cloud_pos[i].first - camera.x * Settings::CLOUD_PARALLAX + margin, span);
+                if (x < 0.0f) x += span;
+                batch.Draw(textures[Textures::Clouds].region, Layers::Clouds,
+                    camera.x + x - margin, cloud_pos[i].second,
+                    clouds_size[i].first, clouds_size[i].second,
                     0.0f, false
                 );
             }
         }
 
-        // floor
-        for (int i = 0; i <= Screen::w / textures[Textures::Floor].dim.w; i++) {
-            GlShaders::Render(model, shader_program, textures[Textures::Floor].texture,
-                textures[Textures::Floor].dim.w * i, Settings::MIN_GROUND_Y - (textures[Textures::Floor].dim.w*0.75), 
-                textures[Textures::Floor].dim.w, textures[Textures::Floor].dim.w,
-                0.0f, false
-            );
-            GlShaders::Render(model, shader_program, textures[Textures::GroundShawow].texture,
-                textures[Textures::GroundShawow].dim.w * i, Settings::MIN_GROUND_Y, 
-                textures[Textures::GroundShawow].dim.w, textures[Textures::GroundShawow].dim.w,
-                0.0f, false
-            );
+        {
+            PROFILE_SCOPE("ground");
+            if (cached) {
+                batch.Draw(static_layer.Region(), Layers::Ground,
+                    baked.x + baked.w / 2.0f, baked.h / 2.0f,
+                    baked.w, baked.h,
+                    0.0f, false
+                );
+            } else {
+                draw_tiles(view);
+            }
+        }
+
+        // characters, the player on top of the crowd
+        {
+            PROFILE_SCOPE("character");
+            crowd.Render(batch, snapshot.crowd_previous, snapshot.crowd_current, view, FrameTracker::alpha);
+            goblin.Render(batch, snapshot.player_previous, snapshot.player_current, view, FrameTracker::alpha);
+        }
+
+        {
+            PROFILE_SCOPE("flush");
+            Profiler::BeginGpu("flush");
+            batch.End();
+            Profiler::EndGpu();
         }
 
-        // character
-        goblin.Render(model, shader_program, Keys::move_right, Keys::move_left);
+        // Screen pass for the overlay and cursor
+        set_projection();
+        batch.ClearView();
+        batch.Begin();
 
         // mouse icon
         if (Mouse::visible) { 
-            GlShaders::Render(model, shader_program, Mouse::texture,
+            PROFILE_SCOPE("cursor");
+            batch.Draw(Mouse::texture, Layers::Mouse,
                 //Mouse::pos_x * ((float)Screen::w / window_w), (Screen::h - (Mouse::pos_y * ((float)Screen::h / window_h)) - 16), 
                 Mouse::pos_x * ((float)Screen::w / window_w), (Screen::h - (Mouse::pos_y * ((float)Screen::h / window_h))), 
                 Mouse::size_x, Mouse::size_y,
@@ -218,7 +581,146 @@ int main(int argc, char* argv[]) {
             );
         }
 
-        glfwSwapBuffers(window);
+        if (hud.visible) {
+            PROFILE_SCOPE("hud");
+            hud.Submit(batch);
+        }
+
+        PROFILE_SCOPE("overlay");
+        batch.End();
+    };
+
+    if (options.bench_tiles) {
+        Bench::TilePaths(gpu_timer, [&]() { set_projection(); }, [&](bool instancing, bool layer_cache) {
+            options.instancing = instancing;
+            options.layer_cache = layer_cache;
+            render_world(simulation.Latest());
+        });
+        glfwTerminate();
+        return 0;
+    }
+
+    // Hands the Keys state to the simulation, jumps on the press edge only
+    auto feed_input = [&]() {
+        simulation.input.move_left = Keys::move_left;
+        simulation.input.move_right = Keys::move_right;
+        simulation.input.sprint = Keys::sprint_pressed;
+        if (Keys::jump_pressed && !Keys::space_key_pressed_last_frame) {
+            simulation.input.jump = true;
+        }
+        Keys::space_key_pressed_last_frame = Keys::jump_pressed;
+    };
+
+    if (options.headless) {
+        // Simulated time advances a fixed 1/60 s per frame so every run ticks
+        // the same way, only the wall clock cost of each frame is measured.
+        const double frame_dt = 1.0 / 60.0;
+        vector<double> frame_ms, simulation_ms, render_ms;
+        // A replay runs until the log does instead of for --frames
+        bool replaying = simulation.replay != nullptr;
+        for (int frame = 0; replaying ? !simulation.ReplayDone() : frame < options.frames; frame++) {
+            PROFILE_SCOPE("frame");
+            Profiler::CollectGpu();
+            auto frame_start = chrono::steady_clock::now();
+            {
+                PROFILE_SCOPE("input");
+                ScriptedInput(frame);
+                feed_input();
+            }
+
+            double now = frame * frame_dt;
+            FrameTracker::dt = static_cast<float>(frame_dt);
+            simulation.Advance(now);
+            auto simulated = chrono::steady_clock::now();
+
+            const FrameSnapshot& snapshot = simulation.Latest();
+            FrameTracker::alpha = simulation.Alpha(snapshot, now);
+            render_world(snapshot);
+            auto submitted = chrono::steady_clock::now();
+            {
+                PROFILE_SCOPE("finish");
+                glFinish();
+            }
+            auto rendered = chrono::steady_clock::now();
+
+            simulation_ms.push_back(chrono::duration<double, milli>(simulated - frame_start).count());
+            render_ms.push_back(chrono::duration<double, milli>(rendered - simulated).count());
+            frame_ms.push_back(chrono::duration<double, milli>(rendered - frame_start).count());
+            Profiler::FrameDone(frame_ms.back());
+            hud.Push({static_cast<float>(frame_ms.back()), simulation.LastTickMs(),
+                chrono::duration<float, milli>(submitted - simulated).count(), -1.0f,
+                RenderStats::draw_calls, RenderStats::texture_binds, RenderStats::sprites, crowd.Size() + 1});
+        }
+        Profiler::CollectGpu();
+
+        Bench::PrintHeader("Headless, " + to_string(frame_ms.size()) + " frames at " + to_string(Screen::w) + "x" + to_string(Screen::h));
+        Bench::PrintRow("frame", Bench::Summarize(frame_ms));
+        Bench::PrintRow("simulation", Bench::Summarize(simulation_ms), to_string(crowd.Size() + 1) + " characters");
+        Bench::PrintRow("render", Bench::Summarize(render_ms),
+            "draws " + to_string(RenderStats::draw_calls) + ", sprites " + to_string(RenderStats::sprites)
+            + ", culled " + to_string(RenderStats::culled) + ", buffer stalls " + to_string(batch.Stalls()));
+
+        if (!options.dump_path.empty()) WritePPM(options.dump_path, headless->ReadPixels(), Screen::w, Screen::h);
+        if (!options.trace_path.empty()) Profiler::WriteChromeTrace(options.trace_path);
+        return finish_logs();
+    }
+
+    // Simulation runs on its own thread from here on, the loop below only
+    // polls input and renders the newest snapshot.
+    if (options.sim_thread) simulation.Start();
+    FrameTracker::last_frame_time = glfwGetTime();
+    bool hud_key_last = false;
+
+    while (!glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("frame");
+        Profiler::CollectGpu();
+        glfwGetWindowSize(window, &window_w, &window_h);
+
+        FrameTracker::current_frame_time = glfwGetTime();
+        FrameTracker::dt = FrameTracker::current_frame_time - FrameTracker::last_frame_time;
+        FrameTracker::last_frame_time = FrameTracker::current_frame_time;
+        FrameTracker::worst_dt = max(FrameTracker::worst_dt, FrameTracker::dt);
+        if (FrameTracker::total_frames > 0) Profiler::FrameDone(FrameTracker::dt * 1000.0);
+        
+        {
+            PROFILE_SCOPE("input");
+            glfwPollEvents();
+            Keys::move_left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+            Keys::move_right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+            Keys::jump_pressed = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+            Keys::sprint_pressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+
+            bool hud_key = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+            if (hud_key && !hud_key_last) hud.visible = !hud.visible;
+            hud_key_last = hud_key;
+
+            feed_input();
+        }
+
+        if (simulation.replay && simulation.ReplayDone()) glfwSetWindowShouldClose(window, true);
+
+        double now = simulation.Now();
+        if (!options.sim_thread) simulation.Advance(now);
+        const FrameSnapshot& snapshot = simulation.Latest();
+        FrameTracker::alpha = simulation.Alpha(snapshot, now);
+
+        auto render_start = chrono::steady_clock::now();
+        gpu_timer.Begin();
+        render_world(snapshot);
+        gpu_timer.End();
+        hud.Push({FrameTracker::dt * 1000.0f, simulation.LastTickMs(),
+            chrono::duration<float, milli>(chrono::steady_clock::now() - render_start).count(), static_cast<float>(gpu_timer.LastMs()),
+            RenderStats::draw_calls, RenderStats::texture_binds, RenderStats::sprites, crowd.Size() + 1});
+
+        {
+            PROFILE_SCOPE("swap");
+            glfwSwapBuffers(window);
+        }
+
+        if (FrameTracker::total_frames++ == 0) {
+            cout << "Time to first frame: "
+                 << chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count() << " ms\n";
+        }
 
         FrameTracker::frame_count++;
         FrameTracker::fps_timer += FrameTracker::dt;
@@ -227,17 +729,26 @@ int main(int argc, char* argv[]) {
 
             FrameTracker::fps_timer = 0.0f;
             FrameTracker::frame_count = 0;
-
-            std::string title = "2D Character Sprites - FPS: " + std::to_string(static_cast<int>(FrameTracker::fps));
+            FrameTracker::worst_dt = 0.0f;
+
+            std::string title = "2D Character Sprites - FPS: " + std::to_string(static_cast<int>(FrameTracker::fps))
+                + " - Draws: " + std::to_string(RenderStats::draw_calls)
+                + " - Binds: " + std::to_string(RenderStats::texture_binds)
+                + " - GPU: " + std::to_string(gpu_timer.LastMs()).substr(0, 5) + " ms"
+                + " - Worst: " + std::to_string(FrameTracker::worst_dt * 1000.0f).substr(0, 5) + " ms";
+            if (crowd.Size()) title += " - Goblins: " + std::to_string(crowd.Size() + 1);
             glfwSetWindowTitle(window, title.c_str());
         }
     }
 
-    glDeleteVertexArrays(1, &VAO); 
-    glDeleteBuffers(1, &VBO); 
-    glDeleteBuffers(1, &EBO); 
-    glDeleteProgram(shader_program);
+    simulation.Stop();
+    if (options.profile) {
+        Bench::PrintHeader("Profile, " + to_string(FrameTracker::total_frames) + " frames");
+        Bench::PrintRow("frame", Profiler::FrameStats());
+    }
+    if (!options.trace_path.empty()) Profiler::WriteChromeTrace(options.trace_path);
+    int status = finish_logs();
 
     glfwTerminate();
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include <animation.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <quad_transform.hpp>
+
+namespace {
+    // Character::BodyParts order
+    enum Parts { Head = 0, Torso = 1, LeftArm = 2, RightArm = 3, LeftLeg = 4, RightLeg = 5 };
+
+    // Humanoid layout, offsets in units of part sizes. The joint sits at
+    // parent_* times the parent's size plus own_* times the bone's own size
+    // from the parent's center, the sprite center pivot times its size below.
+    struct BoneDef {
+        const char* name;
+        int parent;
+        int part;
+        float parent_x, parent_y;
+        float own_x, own_y;
+        float pivot;
+    };
+
+    const BoneDef HUMANOID[] = {
+        {"torso",     -1, Torso,     0.0f,   0.0f,  0.0f,  0.0f,  0.0f},
+        {"head",       0, Head,      0.0f,   0.0f,  0.0f,  0.5f,  0.0f},
+        {"left_arm",   0, LeftArm,   0.25f,  0.0f,  0.0f,  0.25f, 0.25f},
+        {"right_arm",  0, RightArm, -0.2f,   0.0f,  0.0f,  0.25f, 0.25f},
+        {"left_leg",   0, LeftLeg,   0.0f,  -0.25f, -0.33f, 0.25f, 0.25f},
+        {"right_leg",  0, RightLeg,  0.0f,  -0.25f, 0.5f,  0.25f, 0.25f},
+    };
+    enum HumanoidBones { TorsoBone, HeadBone, LeftArmBone, RightArmBone, LeftLegBone, RightLegBone };
+
+    constexpr size_t MAX_BONES = 16;
+
+    // One cycle of sin, exact at the quarter points
+    Animation::Curve SineCurve(float sign) {
+        const float slope = sign * 2.0f * static_cast<float>(M_PI);
+        return {{
+            {0.0f, 0.0f, slope},
+            {0.25f, sign, 0.0f},
+            {0.5f, 0.0f, -slope},
+            {0.75f, -sign, 0.0f},
+        }};
+    }
+}
+
+float Animation::Curve::Sample(float t) const {
+    if (keys.empty()) return 0.0f;
+    if (keys.size() == 1) return keys[0].value;
+
+    t -= floor(t);
+    // Last key at or before t, wrapping to the final key before the first
+    size_t k = keys.size() - 1;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i].time > t) break;
+        k = i;
+    }
+    size_t next = k + 1 == keys.size() ? 0 : k + 1;
+    const Key& a = keys[k];
+    const Key& b = keys[next];
+    float t0 = a.time;
+    float t1 = next == 0 ? b.time + 1.0f : b.time;
+    if (t < t0) t += 1.0f;
+
+    float h = t1 - t0;
+    float s = (t - t0) / h;
+    float s2 = s * s;
+    float s3 = s2 * s;
+    return (2.0f * s3 - 3.0f * s2 + 1.0f) * a.value + (s3 - 2.0f * s2 + s) * h * a.slope
+        + (-2.0f * s3 + 3.0f * s2) * b.value + (s3 - s2) * h * b.slope;
+}
+
+float Animation::Curve::MaxSecondDerivative() const {
+    if (keys.size() < 2) return 0.0f;
+    float worst = 0.0f;
+    for (size_t k = 0; k < keys.size(); k++) {
+        size_t next = k + 1 == keys.size() ? 0 : k + 1;
+        const Key& a = keys[k];
+        const Key& b = keys[next];
+        float h = (next == 0 ? b.time + 1.0f : b.time) - a.time;
+        // Second derivatives of the Hermite basis at s = 0 and s = 1
+        for (float s : {0.0f, 1.0f}) {
+            float d2 = (12.0f * s - 6.0f) * a.value + (6.0f * s - 4.0f) * h * a.slope
+                + (6.0f - 12.0f * s) * b.value + (6.0f * s - 2.0f) * h * b.slope;
+            worst = max(worst, abs(d2) / (h * h));
+        }
+    }
+    return worst;
+}
+
+Animation::Rig Animation::Rig::Humanoid(const array<float, 6>& part_sizes) {
+    Rig rig;
+    for (const BoneDef& def : HUMANOID) {
+        float own = part_sizes[def.part];
+        float parent = def.parent < 0 ? 0.0f : part_sizes[HUMANOID[def.parent].part];
+        rig.bones.push_back({
+            def.name, def.parent, def.part, own,
+            def.parent_x * parent + def.own_x * own,
+            def.parent_y * parent + def.own_y * own,
+            def.pivot * own,
+        });
+    }
+    // The far arm goes behind the torso, the near one in front
+    rig.draw_order[0] = {LeftLegBone, RightLegBone, LeftArmBone, TorsoBone, HeadBone, RightArmBone};
+    rig.draw_order[1] = {LeftLegBone, RightLegBone, RightArmBone, TorsoBone, HeadBone, LeftArmBone};
+    return rig;
+}
+
+void Animation::Rig::Submit(
+    SpriteBatch& batch,
+    const Textures::Region* part_regions,
+    const float* pose,
+    float x,
+    float y,
+    bool flip_x,
+    int layer,
+    int layer_step
+) const {
+    if (bones.size() > MAX_BONES) throw runtime_error("Rig has too many bones");
+
+    const RotationTable* table = use_tables ? &Rotations() : nullptr;
+    array<QuadTransform::Rotation, MAX_BONES> rotation;
+    array<QuadTransform::Point, MAX_BONES> center;
+    for (size_t b = 0; b < bones.size(); b++) {
+        const Bone& bone = bones[b];
+        QuadTransform::Rotation local = QuadTransform::IDENTITY;
+        if (pose[b] != 0.0f) local = table ? table->Degrees(pose[b]) : QuadTransform::Rotation::Degrees(pose[b]);
+
+        QuadTransform::Point joint = {x, y};
+        if (bone.parent >= 0) {
+            const QuadTransform::Rotation& p = rotation[bone.parent];
+            const QuadTransform::Point& c = center[bone.parent];
+            joint = {c.x + p.cos * bone.joint_x - p.sin * bone.joint_y, c.y + p.sin * bone.joint_x + p.cos * bone.joint_y};
+            // Angle sum, no trig past the local rotation
+            local = {p.sin * local.cos + p.cos * local.sin, p.cos * local.cos - p.sin * local.sin};
+        }
+        rotation[b] = local;
+        center[b] = {joint.x + local.sin * bone.pivot, joint.y - local.cos * bone.pivot};
+    }
+
+    const vector<int>& order = draw_order[flip_x ? 1 : 0];
+    for (size_t slot = 0; slot < order.size(); slot++) {
+        int b = order[slot];
+        const Bone& bone = bones[b];
+        batch.Draw(part_regions[bone.part], layer + static_cast<int>(slot) * layer_step,
+            center[b].x, center[b].y, bone.size, bone.size, rotation[b], flip_x);
+    }
+}
+
+const Animation::Clip& Animation::Walk() {
+    static const Clip walk = {"walk", {
+        {},               // torso
+        {},               // head
+        SineCurve(-1.0f), // left arm
+        SineCurve(1.0f),  // right arm
+        SineCurve(1.0f),  // left leg
+        SineCurve(-1.0f), // right leg
+    }};
+    return walk;
+}
+
+bool Animation::use_tables = false;
+
+void Animation::Evaluate(const Clip& clip, const float* phase, const float* weight, size_t n, float* poses) {
+    const size_t n_bones = clip.tracks.size();
+    const float cycles_per_radian = static_cast<float>(0.5 / M_PI);
+    for (size_t b = 0; b < n_bones; b++) {
+        const Curve& track = clip.tracks[b];
+        if (track.keys.empty()) {
+            for (size_t i = 0; i < n; i++) poses[i * n_bones + b] = 0.0f;
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            poses[i * n_bones + b] = weight[i] * track.Sample(phase[i] * cycles_per_radian);
+        }
+    }
+}
+
+Animation::Table::Table(const Clip& clip, int resolution) : resolution(resolution), n_bones(clip.tracks.size()) {
+    if (resolution < 1) throw runtime_error("Table resolution must be positive");
+    samples.resize((resolution + 1) * n_bones);
+    for (int k = 0; k <= resolution; k++) {
+        float t = static_cast<float>(k % resolution) / resolution;
+        for (size_t b = 0; b < n_bones; b++) {
+            samples[k * n_bones + b] = clip.tracks[b].Sample(t);
+        }
+    }
+}
+
+void Animation::Table::Evaluate(const float* phase, const float* weight, size_t n, float* poses) const {
+    const float samples_per_radian = static_cast<float>(resolution * 0.5 / M_PI);
+    for (size_t i = 0; i < n; i++) {
+        float x = phase[i] * samples_per_radian;
+        x -= floor(x / resolution) * resolution;
+        int k = min(static_cast<int>(x), resolution - 1);
+        float f = x - k;
+
+        const float* a = &samples[k * n_bones];
+        const float* b = a + n_bones;
+        float* pose = poses + i * n_bones;
+        for (size_t bone = 0; bone < n_bones; bone++) {
+            pose[bone] = weight[i] * (a[bone] + (b[bone] - a[bone]) * f);
+        }
+    }
+}
+
+Animation::RotationTable::RotationTable(int steps_per_degree) : steps_per_degree(steps_per_degree), period(360 * steps_per_degree) {
+    if (steps_per_degree < 1) throw runtime_error("RotationTable steps must be positive");
+    samples.resize(period + 1);
+    for (int k = 0; k <= period; k++) {
+        samples[k] = QuadTransform::Rotation::Degrees(static_cast<float>(k % period) / steps_per_degree);
+    }
+}
+
+QuadTransform::Rotation Animation::RotationTable::Degrees(float angle) const {
+    float x = angle * steps_per_degree;
+    x -= floor(x / period) * period;
+    int k = min(static_cast<int>(x), period - 1);
+    float f = x - k;
+    const QuadTransform::Rotation& a = samples[k];
+    const QuadTransform::Rotation& b = samples[k + 1];
+    return {a.sin + (b.sin - a.sin) * f, a.cos + (b.cos - a.cos) * f};
+}
+
+const Animation::Table& Animation::WalkTable() {
+    static const Table table(Walk());
+    return table;
+}
+
+const Animation::RotationTable& Animation::Rotations() {
+    static const RotationTable table;
+    return table;
+}
+
+void Animation::EvaluateWalk(const float* phase, const float* weight, size_t n, float* poses) {
+    if (use_tables) {
+        WalkTable().Evaluate(phase, weight, n, poses);
+    } else {
+        Evaluate(Walk(), phase, weight, n, poses);
+    }
+}
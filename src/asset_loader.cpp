@@ -0,0 +1,128 @@
+#include <asset_loader.hpp>
+
+#include <stdexcept>
+
+#include <glad/glad.h>
+
+#include <texture_cache.hpp>
+
+#include "stb_image.h"
+
+Image DecodeImage(const string& path) {
+    Image image;
+    if (TextureCache::Load(path, image)) return image;
+
+    // The flag is per thread, the global setter would race with other workers.
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    int nr_components;
+    unsigned char* data = stbi_load(path.c_str(), &image.w, &image.h, &nr_components, 4);
+    if (!data) throw runtime_error("Failed to load texture: " + path);
+
+    // Premultiplied alpha, so filtering and mipmaps don't pull in the color
+    // of fully transparent texels.
+    size_t n_pixels = static_cast<size_t>(image.w) * image.h;
+    for (size_t i = 0; i < n_pixels; i++) {
+        unsigned char* p = data + i * 4;
+        unsigned int a = p[3];
+        p[0] = static_cast<unsigned char>((p[0] * a + 127) / 255);
+        p[1] = static_cast<unsigned char>((p[1] * a + 127) / 255);
+        p[2] = static_cast<unsigned char>((p[2] * a + 127) / 255);
+    }
+
+    image.path = path;
+    image.pixels = shared_ptr<unsigned char>(data, stbi_image_free);
+    TextureCache::Store(path, image);
+    return image;
+}
+
+unsigned int UploadTexture(const Image& image) {
+    unsigned int texture_id;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.w, image.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get());
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture_id;
+}
+
+AssetLoader::AssetLoader(unsigned int n_threads) : queued(0), polled(0), stopping(false) {
+    for (unsigned int i = 0; i < n_threads; i++) {
+        workers.emplace_back(&AssetLoader::Worker, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void AssetLoader::Queue(const string& path) {
+    if (workers.empty()) {
+        Image image = DecodeImage(path);
+        lock_guard<mutex> guard(lock);
+        finished.push_back(move(image));
+        queued++;
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        jobs.push_back(path);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+vector<Image> AssetLoader::Poll() {
+    lock_guard<mutex> guard(lock);
+    if (error) rethrow_exception(error);
+
+    vector<Image> ready;
+    ready.swap(finished);
+    polled += ready.size();
+    return ready;
+}
+
+void AssetLoader::Wait(chrono::milliseconds timeout) {
+    unique_lock<mutex> guard(lock);
+    ready.wait_for(guard, timeout, [&]() { return !finished.empty() || error || polled == queued; });
+}
+
+bool AssetLoader::Done() {
+    lock_guard<mutex> guard(lock);
+    return polled == queued;
+}
+
+void AssetLoader::Worker() {
+    while (true) {
+        string path;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            path = move(jobs.front());
+            jobs.pop_front();
+        }
+
+        try {
+            Image image = DecodeImage(path);
+            lock_guard<mutex> guard(lock);
+            finished.push_back(move(image));
+        } catch (...) {
+            lock_guard<mutex> guard(lock);
+            if (!error) error = current_exception();
+        }
+        ready.notify_all();
+    }
+}
@@ -0,0 +1,378 @@
+#include <bench.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <character.hpp>
+#include <crowd.hpp>
+#include <animation.hpp>
+#include <collision.hpp>
+#include <quad_transform.hpp>
+#include <sprite_batch.hpp>
+#include <gpu_timer.hpp>
+#include <settings.hpp>
+
+namespace Bench {
+    Stats Summarize(vector<double> samples_ms) {
+        if (samples_ms.empty()) return {0.0, 0.0, 0.0, 0.0, 0.0};
+        sort(samples_ms.begin(), samples_ms.end());
+
+        auto percentile = [&](double p) {
+            size_t i = static_cast<size_t>(p * (samples_ms.size() - 1) + 0.5);
+            return samples_ms[i];
+        };
+        double sum = accumulate(samples_ms.begin(), samples_ms.end(), 0.0);
+        return {sum / samples_ms.size(), percentile(0.50), percentile(0.95), percentile(0.99), samples_ms.front()};
+    }
+
+    Stats Time(int iterations, const function<void()>& fn, const function<void()>& between) {
+        vector<double> samples_ms;
+        samples_ms.reserve(iterations);
+        for (int i = 0; i < iterations; i++) {
+            auto start = chrono::steady_clock::now();
+            fn();
+            auto end = chrono::steady_clock::now();
+            samples_ms.push_back(chrono::duration<double, milli>(end - start).count());
+            if (between) between();
+        }
+        return Summarize(samples_ms);
+    }
+
+    void PrintHeader(const string& title) {
+        printf("\n%s\n", title.c_str());
+        printf("%-28s %10s %10s %10s %10s %10s\n", "", "mean ms", "p50 ms", "p95 ms", "p99 ms", "min ms");
+    }
+
+    void PrintRow(const string& label, const Stats& stats, const string& extra) {
+        printf("%-28s %10.4f %10.4f %10.4f %10.4f %10.4f  %s\n",
+            label.c_str(), stats.mean_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.min_ms, extra.c_str());
+    }
+}
+
+void Bench::TilePaths(GpuTimer& gpu_timer, const function<void()>& resize, const function<void(bool instancing, bool layer_cache)>& frame) {
+    // CPU submission time only, the GPU is drained outside the timed region.
+    Bench::PrintHeader("Frame CPU time by virtual width");
+    const unsigned int bench_widths[] = {1440, 1920, 3840, 7680};
+    for (unsigned int w : bench_widths) {
+        Screen::w = w;
+        Screen::h = w * Settings::SCR_HEIGHT / Settings::SCR_WIDTH;
+        resize();
+        const struct {
+            const char* name;
+            bool instancing;
+            bool layer_cache;
+        } modes[] = {
+            {" batched", false, false},
+            {" instanced", true, false},
+            {" cached", true, true},
+        };
+        for (auto& mode : modes) {
+            frame(mode.instancing, mode.layer_cache);
+            glFinish();
+            auto timed_frame = [&]() {
+                gpu_timer.Begin();
+                frame(mode.instancing, mode.layer_cache);
+                gpu_timer.End();
+            };
+            Bench::Stats stats = Bench::Time(500, timed_frame, []() { glFinish(); });
+            char gpu[32];
+            snprintf(gpu, sizeof(gpu), "%.3f", gpu_timer.LastMs());
+            Bench::PrintRow(to_string(w) + mode.name, stats,
+                "draws " + to_string(RenderStats::draw_calls) + ", sprites " + to_string(RenderStats::sprites) + ", gpu ms " + gpu);
+        }
+    }
+}
+
+// Character::Update on an array of objects vs the Crowd kernels on the same
+// starting state, timing plus the largest divergence from Character.
+void Bench::CrowdPhysics(const Character& prototype) {
+    const float dt = 1.0f / 60.0f;
+    Bench::PrintHeader("Crowd physics Update by entity count");
+    for (size_t n : {1000, 10000, 100000, 1000000}) {
+        // A few random steps first so some are airborne, walking or against a wall
+        Crowd crowd(prototype, n, 1234);
+        for (int i = 0; i < 30; i++) {
+            crowd.Step(dt);
+        }
+
+        vector<Character> characters(n, prototype);
+        for (size_t i = 0; i < n; i++) {
+            crowd.Store(i, characters[i]);
+        }
+        Crowd scalar = crowd;
+        scalar.simd = false;
+        Crowd simd = crowd;
+        simd.simd = true;
+
+        const int check_steps = 10;
+        for (int step = 0; step < check_steps; step++) {
+            for (auto& character : characters) {
+                character.Update(dt);
+            }
+            scalar.Update(dt);
+            simd.Update(dt);
+        }
+        // Largest divergence from the Character results, positions,
+        // velocities and the limb animation state must match exactly
+        auto check = [&](const Crowd& crowd) {
+            float state_error = 0.0f;
+            Character stored = prototype;
+            for (size_t i = 0; i < n; i++) {
+                crowd.Store(i, stored);
+                const Character& expected = characters[i];
+                state_error = max({state_error,
+                    abs(stored.position[0] - expected.position[0]), abs(stored.position[1] - expected.position[1]),
+                    abs(stored.velocity[0] - expected.velocity[0]), abs(stored.velocity[1] - expected.velocity[1]),
+                    abs(stored.limb_animation_timer - expected.limb_animation_timer),
+                    abs(stored.limb_animation_blend - expected.limb_animation_blend)});
+            }
+            char buffer[96];
+            snprintf(buffer, sizeof(buffer), "state err %g, %s", state_error, state_error == 0.0f ? "ok" : "FAIL");
+            return string(buffer);
+        };
+        string scalar_check = check(scalar);
+        string simd_check = check(simd);
+
+        int iterations = static_cast<int>(max<size_t>(5, 2000000 / n));
+        Bench::PrintRow(to_string(n) + " Character", Bench::Time(iterations, [&]() {
+            for (auto& character : characters) {
+                character.Update(dt);
+            }
+        }));
+        crowd.simd = false;
+        Bench::PrintRow(to_string(n) + " soa scalar", Bench::Time(iterations, [&]() { crowd.Update(dt); }), scalar_check);
+        if (CrowdKernels::Avx2Supported()) {
+            crowd.simd = true;
+            Bench::PrintRow(to_string(n) + " soa avx2", Bench::Time(iterations, [&]() { crowd.Update(dt); }), simd_check);
+        }
+    }
+}
+
+// Sprite corners through the glm matrix path SpriteBatch::Draw used to take,
+// against QuadTransform. Half the quads are unrotated like tiles and torsos.
+void Bench::SpriteCorners() {
+    const size_t n = 100000;
+    struct Quad {
+        float x, y, w, h, angle;
+        bool flip_x;
+    };
+    mt19937 rng(1234);
+    uniform_real_distribution<float> position(0.0f, 1440.0f);
+    uniform_real_distribution<float> size(8.0f, 256.0f);
+    uniform_real_distribution<float> angle(-45.0f, 45.0f);
+    vector<Quad> quads(n);
+    for (size_t i = 0; i < n; i++) {
+        quads[i] = {position(rng), position(rng), size(rng), size(rng), i % 2 ? angle(rng) : 0.0f, (rng() & 1) != 0};
+    }
+    vector<QuadTransform::Rotation> rotations(n);
+    for (size_t i = 0; i < n; i++) {
+        rotations[i] = quads[i].angle == 0.0f ? QuadTransform::IDENTITY : QuadTransform::Rotation::Degrees(quads[i].angle);
+    }
+
+    const float unit[4][2] = {{0.5f, 0.5f}, {0.5f, -0.5f}, {-0.5f, -0.5f}, {-0.5f, 0.5f}};
+    vector<QuadTransform::Point> expected(n * 4), corners(n * 4);
+    auto matrix_path = [&]() {
+        for (size_t i = 0; i < n; i++) {
+            const Quad& q = quads[i];
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(q.x, q.y, 0.0f));
+            if (q.angle != 0.0f) {
+                model = glm::rotate(model, glm::radians(q.angle), glm::vec3(0.0f, 0.0f, 1.0f));
+            }
+            model = glm::scale(model, glm::vec3(q.w * (q.flip_x ? -1.0f : 1.0f), q.h, 1.0f));
+            for (int c = 0; c < 4; c++) {
+                glm::vec4 p = model * glm::vec4(unit[c][0], unit[c][1], 0.0f, 1.0f);
+                expected[i * 4 + c] = {p.x, p.y};
+            }
+        }
+    };
+    auto kernel = [&](bool cached) {
+        for (size_t i = 0; i < n; i++) {
+            const Quad& q = quads[i];
+            QuadTransform::Rotation rotation = cached ? rotations[i]
+                : q.angle == 0.0f ? QuadTransform::IDENTITY : QuadTransform::Rotation::Degrees(q.angle);
+            float half_w = (q.flip_x ? -0.5f : 0.5f) * q.w;
+            if (rotation.Identity()) {
+                QuadTransform::Corners(q.x, q.y, half_w, 0.5f * q.h, &corners[i * 4]);
+            } else {
+                QuadTransform::Corners(q.x, q.y, half_w, 0.5f * q.h, rotation, &corners[i * 4]);
+            }
+        }
+    };
+    auto check = [&]() {
+        float error = 0.0f;
+        for (size_t i = 0; i < n * 4; i++) {
+            error = max({error, abs(corners[i].x - expected[i].x), abs(corners[i].y - expected[i].y)});
+        }
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "max corner err %g px, %s", error, error <= 1e-3f ? "ok" : "FAIL");
+        return string(buffer);
+    };
+
+    Bench::PrintHeader("Sprite corners, " + to_string(n) + " quads");
+    Bench::PrintRow("glm matrix", Bench::Time(50, matrix_path));
+    Bench::Stats stats = Bench::Time(50, [&]() { kernel(false); });
+    Bench::PrintRow("quad kernel", stats, check());
+    stats = Bench::Time(50, [&]() { kernel(true); });
+    Bench::PrintRow("cached sin/cos", stats, check());
+}
+
+// Walk poses for a crowd through the sin per limb the character code used to
+// call, the clip's Hermite curves and the baked table, then the same again
+// posed through Rig::Submit, where the table path also takes its sin/cos from
+// Animation::Rotations. The batch is never ended, so no GL work is timed. The
+// table is checked against the curves it was baked from, within the bound
+// Animation::Table documents.
+void Bench::WalkPoses(const Character& prototype, SpriteBatch& batch) {
+    const size_t n = 100000;
+    const Animation::Clip& clip = Animation::Walk();
+    const Animation::Table& table = Animation::WalkTable();
+    Animation::Rotations();
+    const size_t n_bones = clip.tracks.size();
+    const float max_weight = 45.0f;
+
+    mt19937 rng(1234);
+    uniform_real_distribution<float> phase_dist(0.0f, 200.0f * static_cast<float>(M_PI));
+    uniform_real_distribution<float> weight_dist(0.0f, max_weight);
+    uniform_real_distribution<float> position_dist(0.0f, 1000.0f);
+    vector<float> phase(n), weight(n), x(n), y(n);
+    for (size_t i = 0; i < n; i++) {
+        phase[i] = phase_dist(rng);
+        weight[i] = weight_dist(rng);
+        x[i] = position_dist(rng);
+        y[i] = position_dist(rng);
+    }
+
+    vector<float> expected(n * n_bones), curves(n * n_bones), poses(n * n_bones);
+    auto analytic = [&]() {
+        for (size_t i = 0; i < n; i++) {
+            float swing = weight[i] * sin(phase[i]);
+            float* pose = &expected[i * n_bones];
+            pose[0] = 0.0f;
+            pose[1] = 0.0f;
+            pose[2] = -swing;
+            pose[3] = swing;
+            pose[4] = swing;
+            pose[5] = -swing;
+        }
+    };
+    auto error = [&](const vector<float>& reference) {
+        float worst = 0.0f;
+        for (size_t i = 0; i < n * n_bones; i++) worst = max(worst, abs(poses[i] - reference[i]));
+        return worst;
+    };
+
+    Bench::PrintHeader("Walk poses, " + to_string(n) + " characters");
+    Bench::PrintRow("analytic sin", Bench::Time(50, analytic));
+    Bench::Stats stats = Bench::Time(50, [&]() { Animation::Evaluate(clip, phase.data(), weight.data(), n, poses.data()); });
+    curves = poses;
+    char buffer[96];
+    snprintf(buffer, sizeof(buffer), "max err %g deg against sin", error(expected));
+    Bench::PrintRow("hermite curves", stats, buffer);
+
+    float curvature = 0.0f;
+    for (const Animation::Curve& track : clip.tracks) curvature = max(curvature, track.MaxSecondDerivative());
+    stats = Bench::Time(50, [&]() { table.Evaluate(phase.data(), weight.data(), n, poses.data()); });
+    float table_error = error(curves);
+    float resolution = static_cast<float>(table.Resolution());
+    float bound = max_weight * curvature / (8.0f * resolution * resolution) + 1e-4f;
+    snprintf(buffer, sizeof(buffer), "max err %g deg against curves, bound %g, %s", table_error, bound,
+        table_error <= bound ? "ok" : "FAIL");
+    Bench::PrintRow("pose table " + to_string(table.Resolution()), stats, buffer);
+
+    array<Textures::Region, 6> regions;
+    for (size_t part = 0; part < regions.size(); part++) {
+        regions[part] = *prototype.textures[part];
+    }
+    bool use_tables = Animation::use_tables;
+    auto posed = [&](bool tables) {
+        Animation::use_tables = tables;
+        Bench::Stats stats = Bench::Time(20, [&]() {
+            Animation::EvaluateWalk(phase.data(), weight.data(), n, poses.data());
+            batch.Begin();
+            for (size_t i = 0; i < n; i++) {
+                prototype.rig.Submit(batch, regions.data(), &poses[i * n_bones], x[i], y[i], i % 2 != 0, Layers::Crowd, 0);
+            }
+        });
+        Animation::use_tables = use_tables;
+        return stats;
+    };
+    Bench::PrintRow("curves + rig", posed(false));
+    Bench::PrintRow("tables + rig", posed(true));
+    batch.Begin();
+}
+
+// Overlapping pairs among goblin sized boxes at a fixed density, so the
+// expected pair count grows linearly. Each timed run first nudges every box by
+// a few pixels like a tick of movement. The grid is timed rebuilt from scratch
+// and updated in place, and both are checked against the pairwise test.
+void Bench::CollisionPairs() {
+    const float cell_size = 160.0f;
+    Bench::PrintHeader("Collision pairs by box count");
+    for (size_t n : {1000, 10000, 100000}) {
+        mt19937 rng(1234);
+        float world = sqrt(static_cast<float>(n)) * 400.0f;
+        uniform_real_distribution<float> position(0.0f, world);
+        uniform_real_distribution<float> size(60.0f, 150.0f);
+        uniform_real_distribution<float> step(-4.0f, 4.0f);
+        vector<Collision::Box> boxes(n);
+        for (auto& box : boxes) {
+            box = {position(rng), position(rng), size(rng), size(rng)};
+        }
+        auto move = [&]() {
+            for (auto& box : boxes) {
+                box.x += step(rng);
+                box.y += step(rng);
+            }
+        };
+
+        auto sorted = [](vector<Collision::Pair> pairs) {
+            sort(pairs.begin(), pairs.end(), [](const Collision::Pair& l, const Collision::Pair& r) {
+                return l.a != r.a ? l.a < r.a : l.b < r.b;
+            });
+            return pairs;
+        };
+        vector<Collision::Pair> expected, pairs;
+        // The pairwise test at 100k boxes takes tens of seconds a run
+        bool brute_force = n <= 10000;
+        int iterations = static_cast<int>(max<size_t>(5, 1000000 / n));
+
+        if (brute_force) {
+            Bench::PrintRow(to_string(n) + " pairwise", Bench::Time(max(3, iterations / 20), [&]() {
+                move();
+                Collision::BruteForcePairs(boxes.data(), n, expected);
+            }));
+        }
+        auto check = [&]() {
+            if (!brute_force) return to_string(pairs.size()) + " pairs";
+            Collision::BruteForcePairs(boxes.data(), n, expected);
+            vector<Collision::Pair> found = sorted(pairs);
+            bool match = found.size() == expected.size() && equal(expected.begin(), expected.end(), found.begin(),
+                [](const Collision::Pair& l, const Collision::Pair& r) { return l.a == r.a && l.b == r.b; });
+            return to_string(pairs.size()) + " pairs, " + (match ? "ok" : "FAIL");
+        };
+
+        Collision::SpatialHash grid(cell_size);
+        Bench::Stats stats = Bench::Time(iterations, [&]() {
+            move();
+            grid.Clear();
+            for (size_t i = 0; i < n; i++) grid.Update(static_cast<uint32_t>(i), boxes[i]);
+            grid.Pairs(pairs);
+        });
+        Bench::PrintRow(to_string(n) + " grid rebuild", stats, check());
+
+        stats = Bench::Time(iterations, [&]() {
+            move();
+            for (size_t i = 0; i < n; i++) grid.Update(static_cast<uint32_t>(i), boxes[i]);
+            grid.Pairs(pairs);
+        });
+        Bench::PrintRow(to_string(n) + " grid incremental", stats, check());
+    }
+}
@@ -0,0 +1,26 @@
+#include <camera.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace std;
+
+float Camera::Clamp(float left, float world_w) const {
+    return max(0.0f, min(left, world_w - w));
+}
+
+void Camera::Follow(float target_x, float world_w, float dt) {
+    float goal = Clamp(target_x - w * 0.5f, world_w);
+    x += (goal - x) * (1.0f - exp(-FOLLOW_RATE * dt));
+    x = Clamp(x, world_w);
+}
+
+void Camera::Snap(float target_x, float world_w) {
+    x = Clamp(target_x - w * 0.5f, world_w);
+}
+
+glm::mat4 Camera::Projection() const {
+    return glm::ortho(x, x + w, y, y + h);
+}
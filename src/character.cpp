@@ -1,54 +1,33 @@
 #include <character.hpp>
 
-unsigned int LoadTexture(char const* path) {
-    stbi_set_flip_vertically_on_load(true);
-    unsigned int texture_id;
-    glGenTextures(1, &texture_id);
-  
-    int width, height, nr_components;
-    unsigned char *data = stbi_load(path, &width, &height, &nr_components, 0);
-    if (data) {
-        GLenum format;
-        switch (nr_components){
-        case 1:
-            format = GL_RED;
-            break;
-        case 3:
-            format = GL_RGB;
-            break;
-        case 4:
-            format = GL_RGBA;
-            break;
-        default:
-            format = GL_RGBA;
-            break;
-        }
+#include <algorithm>
 
-        glBindTexture(GL_TEXTURE_2D, texture_id);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);    
+#include <state_hash.hpp>
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);  
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);  
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);  
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);  
+unsigned int LoadTexture(char const* path) {
+    return UploadTexture(DecodeImage(path));
+}
 
-        stbi_image_free(data);
-    } else {
-        throw runtime_error("Failed to load texture");
-        stbi_image_free(data);
+vector<string> Character::TexturePaths(int character_type) {
+    auto character = Characters.find(character_type);
+    if (character == Characters.end()) throw runtime_error("Character type not found");
+
+    vector<string> paths;
+    for (auto& part : character->second) {
+        paths.push_back(part.second.path);
     }
-    return texture_id;
+    paths.push_back(collision_texture_path);
+    return paths;
 }
 
-Character::Character(int character_type, bool debug_mode) {
+Character::Character(int character_type, TextureManager& texture_manager, bool debug_mode) {
     auto character = Characters.find(character_type);
     if (character == Characters.end()) throw runtime_error("Character type not found");
 
-    auto lfn = [&](int part, unsigned int& texture, float& size) {
+    auto lfn = [&](int part, TextureHandle& texture, float& size) {
         auto it = character->second.find(part);
         if (it == character->second.end()) throw runtime_error("Body part not found");
-        texture = LoadTexture(it->second.path.c_str());
+        texture = texture_manager.Acquire(it->second.path);
         size = it->second.size;
     };
 
@@ -59,10 +38,7 @@ Character::Character(int character_type, bool debug_mode) {
     height = texture_sizes[Torso] + (texture_sizes[Head] * 0.5f) + (texture_sizes[LeftLeg] * 0.33f);
     width = (texture_sizes[Torso] > texture_sizes[Head]) ? texture_sizes[Torso] : texture_sizes[Head];
     
-    left_leg_angle = 0.0f;
-    right_leg_angle = 0.0f;
-    left_arm_angle = 0.0f;
-    right_arm_angle = 0.0f;
+    rig = Animation::Rig::Humanoid(texture_sizes);
     limb_animation_timer = 0.0f;
     limb_animation_speed = 5.0f;
     limb_rotation_amplitude = 30.0f;
@@ -72,13 +48,15 @@ Character::Character(int character_type, bool debug_mode) {
     velocity = {0.0f, 0.0f};
     acceleration = {0.0f, 0.0f};
     on_ground = true;
+    time_since_left_ground = -1.0f;
+    time_since_jump_pressed = -1.0f;
 
     is_colliding = false;
+    max_limb_angle = 0.0f;
 
     DEBUG_MODE = debug_mode;
     if (DEBUG_MODE) {
-        max_limb_angle = 0.0f;
-        collision_texture = LoadTexture(collision_texture_path);
+        collision_texture = texture_manager.Acquire(collision_texture_path);
         collision_texture_size = collision_texture_init_size;
     }
 }
@@ -175,11 +153,6 @@ void Character::Update(float dt) {
         }
     }
 
-    left_leg_angle = limb_animation_blend * limb_rotation_amplitude * sin(limb_animation_timer);
-    right_leg_angle = -limb_animation_blend * limb_rotation_amplitude * sin(limb_animation_timer);
-    left_arm_angle = -limb_animation_blend * limb_rotation_amplitude * sin(limb_animation_timer);
-    right_arm_angle = limb_animation_blend * limb_rotation_amplitude * sin(limb_animation_timer);
-
     
     if (position[1] + height >= Settings::SCR_HEIGHT) {
         position[1] = Settings::SCR_HEIGHT - height;
@@ -198,13 +171,13 @@ void Character::Update(float dt) {
     if (position[0] <= 0.0) {
         position[0] = 0.0;
         velocity[0] = 0.0;
-    } else if (position[0] + width >= Settings::SCR_WIDTH) {
-        position[0] = Settings::SCR_WIDTH - width;
+    } else if (position[0] + width >= Settings::WORLD_WIDTH) {
+        position[0] = Settings::WORLD_WIDTH - width;
         velocity[0] = 0.0;
     }
 
     is_colliding = false;
-    if (position[0] <= 0.0f || position[0] + width >= Settings::SCR_WIDTH) {
+    if (position[0] <= 0.0f || position[0] + width >= Settings::WORLD_WIDTH) {
         is_colliding = true;
     }
     if (position[1] + height >= Settings::SCR_HEIGHT || position[1] <= 0.0f) {
@@ -228,80 +201,59 @@ void Character::UpdateTimes(float dt) {
     }
 }
 
-void Character::Render(glm::mat4& model, unsigned int shader_program, bool moving_right, bool moving_left) {
-    // !moving_left
-    /*  1. left-leg  2. right-leg  3. left-arm  4. torso  5. head  6. right-arm  */
-    // moving_left
-    /*  1. left-leg  2. right-leg  3. right-arm  4. torso  5. head  6. left-arm  */
-    float torso_positionX = position[0];
-    float torso_positionY = Screen::h - (position[1] + height * 0.5f);
-
+Character::Pose Character::CurrentPose(bool moving_right, bool moving_left) const {
     bool flip_x = moving_left ? !moving_right : false;
+    return {position, limb_animation_timer, limb_animation_blend * limb_rotation_amplitude, flip_x};
+}
 
-    // Only x offset, y offset is hardly visible while in motion.
-    float r = right_arm_angle * M_PI / 180.0;
-    float l_leg_offset = texture_sizes[LeftLeg] * Settings::CHARACTER_SCALE * r;
-    float r_leg_offset = texture_sizes[RightLeg] * Settings::CHARACTER_SCALE * r;
-    float l_arm_offset = texture_sizes[LeftArm] * Settings::CHARACTER_SCALE * r;
-    float r_arm_offset = texture_sizes[RightArm] * Settings::CHARACTER_SCALE * r;
-
-    GlShaders::Render(model, shader_program, textures[LeftLeg], 
-        torso_positionX - (texture_sizes[LeftLeg] * 0.33) + l_leg_offset, torso_positionY - (texture_sizes[Torso] * 0.25), 
-        texture_sizes[LeftLeg], texture_sizes[LeftLeg],
-        left_leg_angle, flip_x
-    );
-    GlShaders::Render(model, shader_program, textures[RightLeg], 
-        torso_positionX + (texture_sizes[RightLeg] * 0.5) - r_leg_offset, torso_positionY - (texture_sizes[Torso] * 0.25), 
-        texture_sizes[RightLeg], texture_sizes[RightLeg],
-        right_leg_angle, flip_x
-    );
-    
-    if (!flip_x) {
-        GlShaders::Render(model, shader_program, textures[LeftArm], 
-            torso_positionX + (texture_sizes[Torso] * 0.25f) - l_arm_offset, torso_positionY, 
-            texture_sizes[LeftArm], texture_sizes[LeftArm],
-            left_arm_angle, flip_x
-        );
-    } else {
-        GlShaders::Render(model, shader_program, textures[RightArm], 
-            torso_positionX - (texture_sizes[Torso] * 0.2f) + r_arm_offset, torso_positionY, 
-            texture_sizes[RightArm], texture_sizes[RightArm],
-            right_arm_angle, flip_x
-        );
+bool Character::InView(const Collision::Box& view, float x, float y) const {
+    // The rig's center is the torso's, head and swinging limbs stay within
+    // the larger of the width and height of it
+    float reach = max(width, height);
+    return Collision::Overlaps(view, {x - reach, y - reach, 2.0f * reach, 2.0f * reach});
+}
+
+uint64_t Character::Hash(uint64_t hash) const {
+    hash = StateHash::Mix(hash, position[0]);
+    hash = StateHash::Mix(hash, position[1]);
+    hash = StateHash::Mix(hash, velocity[0]);
+    hash = StateHash::Mix(hash, velocity[1]);
+    hash = StateHash::Mix(hash, static_cast<uint32_t>(on_ground));
+
+    float weight = limb_animation_blend * limb_rotation_amplitude;
+    array<float, N_BODYPARTS> pose;
+    Animation::EvaluateWalk(&limb_animation_timer, &weight, 1, pose.data());
+    for (float angle : pose) {
+        hash = StateHash::Mix(hash, angle);
     }
-    
-    GlShaders::Render(model, shader_program, textures[Torso], 
-        torso_positionX, torso_positionY, 
-        texture_sizes[Torso], texture_sizes[Torso],
-        0.0f, flip_x
-    );
-    GlShaders::Render(model, shader_program, textures[Head], 
-        torso_positionX, torso_positionY + (texture_sizes[Head] / 2), 
-        texture_sizes[Head], texture_sizes[Head],
-        0.0f, flip_x
-    );
-
-    if (!flip_x) {
-        GlShaders::Render(model, shader_program, textures[RightArm], 
-            torso_positionX - (texture_sizes[Torso] * 0.2f) + r_arm_offset, torso_positionY, 
-            texture_sizes[RightArm], texture_sizes[RightArm],
-            right_arm_angle, flip_x
-        );
-    } else {
-        GlShaders::Render(model, shader_program, textures[LeftArm], 
-            torso_positionX + (texture_sizes[Torso] * 0.25f) - l_arm_offset, torso_positionY, 
-            texture_sizes[LeftArm], texture_sizes[LeftArm],
-            left_arm_angle, flip_x
-        );
+    return hash;
+}
+
+void Character::Render(SpriteBatch& batch, const Pose& previous, const Pose& current, const Collision::Box& view, float alpha) const {
+    auto lerp = [alpha](float a, float b) { return a + (b - a) * alpha; };
+    float position_x = lerp(previous.position[0], current.position[0]);
+    float position_y = lerp(previous.position[1], current.position[1]);
+    if (!InView(view, position_x, Screen::h - (position_y + height * 0.5f))) return;
+    float phase = lerp(previous.limb_phase, current.limb_phase);
+    float weight = lerp(previous.limb_weight, current.limb_weight);
+
+    array<float, N_BODYPARTS> pose;
+    Animation::EvaluateWalk(&phase, &weight, 1, pose.data());
+
+    array<Textures::Region, N_BODYPARTS> regions;
+    for (int i = 0; i < N_BODYPARTS; i++) {
+        regions[i] = *textures[i];
     }
+    bool flip_x = current.flip_x;
+    rig.Submit(batch, regions.data(), pose.data(), position_x, Screen::h - (position_y + height * 0.5f), flip_x, Layers::Character, 1);
 
     if (DEBUG_MODE) {
-        float box_x = position[0];
-        float box_y = Screen::h - (position[1] + (height * Settings::CHARACTER_SCALE));
+        float box_x = position_x;
+        float box_y = Screen::h - (position_y + (height * Settings::CHARACTER_SCALE));
         float box_width = width;
         float box_height = height;
 
-        GlShaders::Render(model, shader_program, collision_texture, 
+        batch.Draw(*collision_texture, Layers::Character + 6, 
             box_x, box_y, 
             box_width, box_height,
             0.0f, flip_x
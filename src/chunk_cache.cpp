@@ -0,0 +1,92 @@
+#include <chunk_cache.hpp>
+
+#include <stdexcept>
+
+ChunkCache::ChunkCache(const TileMap& map, const vector<Textures::Texture>& textures, size_t max_chunks)
+    : map(map), textures(textures), max_chunks(max_chunks), visible(map.LayerCount()), frame(0), builds(0), evictions(0) {
+    if (textures.size() != map.LayerCount()) throw runtime_error("ChunkCache needs one texture per tile map layer");
+}
+
+uint64_t ChunkCache::Key(size_t layer, int chunk_x, int chunk_y) {
+    return (static_cast<uint64_t>(layer) << 48) | (static_cast<uint64_t>(static_cast<uint32_t>(chunk_y) & 0xffff) << 32)
+        | static_cast<uint32_t>(chunk_x);
+}
+
+void ChunkCache::Build(TileLayer& tiles, size_t layer, int chunk_x, int chunk_y) {
+    const TileMap::Layer& l = map.GetLayer(layer);
+    const Textures::Texture& texture = textures[layer];
+    const uint16_t* ids = map.Chunk(layer, chunk_x, chunk_y);
+
+    scratch.clear();
+    for (int y = 0; y < TileMap::CHUNK_SIZE; y++) {
+        for (int x = 0; x < TileMap::CHUNK_SIZE; x++) {
+            if (ids[y * TileMap::CHUNK_SIZE + x] == 0) continue;
+            float center_x = l.origin_x + (chunk_x * TileMap::CHUNK_SIZE + x) * l.tile_size;
+            float center_y = l.origin_y + (chunk_y * TileMap::CHUNK_SIZE + y) * l.tile_size;
+            scratch.push_back({center_x, center_y, l.tile_size, l.tile_size, texture.region.uv});
+        }
+    }
+    tiles.Build(scratch, texture.region.texture);
+    builds++;
+}
+
+TileLayer& ChunkCache::Acquire(size_t layer, int chunk_x, int chunk_y) {
+    uint64_t key = Key(layer, chunk_x, chunk_y);
+    auto it = resident.find(key);
+    if (it != resident.end()) {
+        Entry& entry = it->second;
+        recent.splice(recent.begin(), recent, entry.recent);
+        entry.used = frame;
+        return *entry.tiles;
+    }
+
+    // Recycle the least recently used chunk's buffers once over budget
+    unique_ptr<TileLayer> tiles;
+    if (resident.size() >= max_chunks && !recent.empty()) {
+        auto oldest = resident.find(recent.back());
+        if (oldest->second.used != frame) {
+            tiles = move(oldest->second.tiles);
+            resident.erase(oldest);
+            recent.pop_back();
+            evictions++;
+        }
+    }
+    if (!tiles) tiles = make_unique<TileLayer>();
+
+    Build(*tiles, layer, chunk_x, chunk_y);
+    recent.push_front(key);
+    Entry& entry = resident[key];
+    entry.tiles = move(tiles);
+    entry.recent = recent.begin();
+    entry.used = frame;
+    return *entry.tiles;
+}
+
+void ChunkCache::Update(float x0, float y0, float x1, float y1, float margin) {
+    frame++;
+    for (size_t layer = 0; layer < map.LayerCount(); layer++) {
+        visible[layer].clear();
+        TileMap::ChunkRange view = map.Overlapping(layer, x0, y0, x1, y1);
+        TileMap::ChunkRange near = map.Overlapping(layer, x0 - margin, y0 - margin, x1 + margin, y1 + margin);
+        for (int y = near.y0; y < near.y1; y++) {
+            for (int x = near.x0; x < near.x1; x++) {
+                TileLayer& tiles = Acquire(layer, x, y);
+                if (x >= view.x0 && x < view.x1 && y >= view.y0 && y < view.y1 && tiles.Size() > 0) {
+                    visible[layer].push_back(&tiles);
+                }
+            }
+        }
+    }
+}
+
+void ChunkCache::Draw(size_t layer) const {
+    for (const TileLayer* tiles : visible[layer]) {
+        tiles->Draw();
+    }
+}
+
+void ChunkCache::Submit(SpriteBatch& batch, size_t layer) const {
+    for (const TileLayer* tiles : visible[layer]) {
+        tiles->Submit(batch, map.GetLayer(layer).sprite_layer);
+    }
+}
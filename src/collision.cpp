@@ -0,0 +1,120 @@
+#include <collision.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void Collision::BruteForcePairs(const Box* boxes, size_t n, vector<Pair>& out) {
+    out.clear();
+    for (size_t a = 0; a < n; a++) {
+        for (size_t b = a + 1; b < n; b++) {
+            if (Overlaps(boxes[a], boxes[b])) out.push_back({static_cast<uint32_t>(a), static_cast<uint32_t>(b)});
+        }
+    }
+}
+
+Collision::SpatialHash::SpatialHash(float cell_size) : size(0) {
+    if (!(cell_size > 0.0f)) throw runtime_error("SpatialHash cell size must be positive");
+    inv_cell_size = 1.0f / cell_size;
+}
+
+Collision::SpatialHash::Range Collision::SpatialHash::Cover(const Box& box) const {
+    return {
+        static_cast<int32_t>(floor(box.x * inv_cell_size)),
+        static_cast<int32_t>(floor(box.y * inv_cell_size)),
+        static_cast<int32_t>(floor((box.x + box.w) * inv_cell_size)),
+        static_cast<int32_t>(floor((box.y + box.h) * inv_cell_size)),
+    };
+}
+
+uint64_t Collision::SpatialHash::Key(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void Collision::SpatialHash::Link(uint32_t id, const Range& range) {
+    for (int32_t y = range.y0; y <= range.y1; y++) {
+        for (int32_t x = range.x0; x <= range.x1; x++) {
+            cells[Key(x, y)].push_back(id);
+        }
+    }
+}
+
+void Collision::SpatialHash::Unlink(uint32_t id, const Range& range) {
+    for (int32_t y = range.y0; y <= range.y1; y++) {
+        for (int32_t x = range.x0; x <= range.x1; x++) {
+            vector<uint32_t>& bucket = cells[Key(x, y)];
+            auto it = find(bucket.begin(), bucket.end(), id);
+            if (it == bucket.end()) continue;
+            *it = bucket.back();
+            bucket.pop_back();
+        }
+    }
+}
+
+void Collision::SpatialHash::Update(uint32_t id, const Box& box) {
+    if (id >= entries.size()) entries.resize(id + 1);
+    Entry& entry = entries[id];
+    Range range = Cover(box);
+    entry.box = box;
+    if (entry.present) {
+        const Range& old = entry.cells;
+        if (old.x0 == range.x0 && old.y0 == range.y0 && old.x1 == range.x1 && old.y1 == range.y1) return;
+        Unlink(id, old);
+    } else {
+        entry.present = true;
+        size++;
+    }
+    entry.cells = range;
+    Link(id, range);
+}
+
+void Collision::SpatialHash::Remove(uint32_t id) {
+    if (id >= entries.size() || !entries[id].present) return;
+    Unlink(id, entries[id].cells);
+    entries[id].present = false;
+    size--;
+}
+
+void Collision::SpatialHash::Clear() {
+    for (auto& cell : cells) cell.second.clear();
+    entries.clear();
+    size = 0;
+}
+
+void Collision::SpatialHash::Pairs(vector<Pair>& out) const {
+    out.clear();
+    for (const auto& cell : cells) {
+        const vector<uint32_t>& bucket = cell.second;
+        if (bucket.size() < 2) continue;
+        int32_t x = static_cast<int32_t>(cell.first >> 32);
+        int32_t y = static_cast<int32_t>(cell.first & 0xffffffffu);
+        for (size_t i = 0; i < bucket.size(); i++) {
+            const Entry& a = entries[bucket[i]];
+            for (size_t j = i + 1; j < bucket.size(); j++) {
+                const Entry& b = entries[bucket[j]];
+                // Boxes sharing several cells meet in all of them, only the
+                // lowest shared cell reports them
+                if (max(a.cells.x0, b.cells.x0) != x || max(a.cells.y0, b.cells.y0) != y) continue;
+                if (!Overlaps(a.box, b.box)) continue;
+                out.push_back({min(bucket[i], bucket[j]), max(bucket[i], bucket[j])});
+            }
+        }
+    }
+}
+
+void Collision::SpatialHash::Query(const Box& box, vector<uint32_t>& out) const {
+    out.clear();
+    Range range = Cover(box);
+    for (int32_t y = range.y0; y <= range.y1; y++) {
+        for (int32_t x = range.x0; x <= range.x1; x++) {
+            auto cell = cells.find(Key(x, y));
+            if (cell == cells.end()) continue;
+            for (uint32_t id : cell->second) {
+                const Entry& entry = entries[id];
+                // Reported from the first cell it shares with the query
+                if (max(entry.cells.x0, range.x0) != x || max(entry.cells.y0, range.y0) != y) continue;
+                if (Overlaps(entry.box, box)) out.push_back(id);
+            }
+        }
+    }
+}
@@ -0,0 +1,281 @@
+#include <crowd.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <state_hash.hpp>
+
+Crowd::Crowd(const Character& prototype, size_t n, uint32_t seed)
+    : textures(prototype.textures), texture_sizes(prototype.texture_sizes), rig(prototype.rig),
+      height(prototype.height), width(prototype.width), rng(seed ? seed : 1), grid(max(prototype.width, prototype.height)) {
+    spawn_y = Settings::MIN_GROUND_Y + (texture_sizes[Character::LeftLeg] / 2);
+
+    pos_x.resize(n);
+    pos_y.assign(n, spawn_y);
+    vel_x.assign(n, 0.0f);
+    vel_y.assign(n, 0.0f);
+    acc_x.assign(n, 0.0f);
+    acc_y.assign(n, 0.0f);
+
+    limb_timer.assign(n, 0.0f);
+    limb_speed.assign(n, 5.0f);
+    limb_amplitude.assign(n, 30.0f);
+    limb_blend.assign(n, 1.0f);
+
+    // Same as a freshly constructed Character, which has never jumped
+    time_since_left_ground.assign(n, -1.0f);
+    time_since_jump_pressed.assign(n, -1.0f);
+    on_ground.assign(n, 1);
+
+    move_left.assign(n, 0);
+    move_right.assign(n, 0);
+    sprinting.assign(n, 0);
+    input_timer.assign(n, 0.0f);
+    colliding.assign(n, 0);
+
+    for (size_t i = 0; i < n; i++) {
+        pos_x[i] = RandomFloat(0.0f, Settings::WORLD_WIDTH - width);
+    }
+}
+
+void Crowd::StorePoses(Poses& poses) const {
+    poses.x.assign(pos_x.begin(), pos_x.end());
+    poses.y.assign(pos_y.begin(), pos_y.end());
+    poses.limb_phase.assign(limb_timer.begin(), limb_timer.end());
+    poses.limb_weight.resize(Size());
+    poses.flip_x.resize(Size());
+    for (size_t i = 0; i < Size(); i++) {
+        poses.limb_weight[i] = limb_blend[i] * limb_amplitude[i];
+        poses.flip_x[i] = move_left[i] && !move_right[i];
+    }
+}
+
+uint32_t Crowd::Random() {
+    // xorshift32, cheap and reproducible from the seed
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+float Crowd::RandomFloat(float lo, float hi) {
+    return lo + (hi - lo) * static_cast<float>(Random() >> 8) / static_cast<float>(1 << 24);
+}
+
+void Crowd::Step(float dt) {
+    RandomizeInputs(dt);
+    Move();
+    UpdateTimes(dt);
+    Jump();
+    Update(dt);
+}
+
+void Crowd::RandomizeInputs(float dt) {
+    size_t n = Size();
+    for (size_t i = 0; i < n; i++) {
+        input_timer[i] -= dt;
+        if (input_timer[i] > 0.0f) continue;
+
+        uint32_t r = Random();
+        uint32_t direction = r % 3;
+        move_left[i] = direction == 1;
+        move_right[i] = direction == 2;
+        sprinting[i] = ((r >> 8) & 3) == 0;
+        if (((r >> 16) & 3) == 0) time_since_jump_pressed[i] = 0.0f;
+        input_timer[i] = RandomFloat(0.25f, 2.0f);
+    }
+}
+
+void Crowd::Move() {
+    // Character::Move with the mass folded out of force / mass
+    size_t n = Size();
+    for (size_t i = 0; i < n; i++) {
+        float sprint_multiplier = sprinting[i] ? 2.0f : 1.0f;
+        if (sprinting[i]) {
+            limb_speed[i] = 7.5f;
+            limb_amplitude[i] = 45.0f;
+        }
+
+        float acc = 0.0f;
+        if (move_left[i]) acc -= Settings::SPEED * sprint_multiplier;
+        if (move_right[i]) acc += Settings::SPEED * sprint_multiplier;
+        if (on_ground[i]) {
+            acc -= vel_x[i] * Settings::FRICTION_CO;
+            if (!move_left[i] && !move_right[i]) acc -= vel_x[i] * (Settings::FRICTION_CO * 10);
+        }
+        acc_x[i] = acc;
+
+        vel_x[i] = min(max(vel_x[i], -Settings::MAX_SPEED), Settings::MAX_SPEED);
+    }
+}
+
+void Crowd::UpdateTimes(float dt) {
+    size_t n = Size();
+    for (size_t i = 0; i < n; i++) {
+        if (time_since_jump_pressed[i] >= 0.0f) {
+            time_since_jump_pressed[i] += dt;
+            if (time_since_jump_pressed[i] > Settings::JUMP_BUFFER_TIME) time_since_jump_pressed[i] = -1.0f;
+        }
+        if (time_since_left_ground[i] >= 0.0f) {
+            time_since_left_ground[i] += dt;
+            if (time_since_left_ground[i] > Settings::COYOTE_TIME) time_since_left_ground[i] = -1.0f;
+        }
+    }
+}
+
+void Crowd::Jump() {
+    // Every member has the prototype's height, so the jump velocity is shared
+    float jump_velocity = sqrt(2.0 * Settings::GRAVITYPX * (height * 0.5));
+
+    size_t n = Size();
+    for (size_t i = 0; i < n; i++) {
+        if (time_since_jump_pressed[i] < 0.0f) continue;
+
+        bool coyote = time_since_left_ground[i] >= 0.0f && time_since_left_ground[i] < Settings::COYOTE_TIME;
+        if (on_ground[i] || coyote) {
+            vel_y[i] = -jump_velocity;
+            on_ground[i] = 0;
+            time_since_jump_pressed[i] = -1.0f;
+        }
+    }
+}
+
+void Crowd::Update(float dt) {
+    CrowdKernels::Arrays arrays = Arrays();
+    CrowdKernels::Params params = {dt, height, width};
+
+    size_t done = simd ? CrowdKernels::UpdateAvx2(arrays, 0, Size(), params) : 0;
+    CrowdKernels::UpdateScalar(arrays, done, Size(), params);
+}
+
+void Crowd::Collide() {
+    size_t n = Size();
+    for (size_t i = 0; i < n; i++) {
+        grid.Update(static_cast<uint32_t>(i), {pos_x[i], pos_y[i], width, height});
+    }
+    grid.Pairs(contacts);
+    sort(contacts.begin(), contacts.end(), [](const Collision::Pair& l, const Collision::Pair& r) {
+        return l.a != r.a ? l.a < r.a : l.b < r.b;
+    });
+    fill(colliding.begin(), colliding.end(), 0);
+    for (const Collision::Pair& pair : contacts) {
+        colliding[pair.a] = 1;
+        colliding[pair.b] = 1;
+    }
+}
+
+bool Crowd::Touches(const Collision::Box& box) {
+    grid.Query(box, hits);
+    return !hits.empty();
+}
+
+void Crowd::Separate() {
+    const float right_x = Settings::WORLD_WIDTH - width;
+    push.assign(Size(), 0.0f);
+    for (const Collision::Pair& pair : contacts) {
+        // Every member is as wide as the prototype. Level members split by
+        // index so the lower one always goes left.
+        float half = 0.5f * (width - abs(pos_x[pair.b] - pos_x[pair.a]));
+        if (half <= 0.0f) continue;
+        if (pos_x[pair.a] > pos_x[pair.b]) half = -half;
+        push[pair.a] -= half;
+        push[pair.b] += half;
+    }
+    for (size_t i = 0; i < push.size(); i++) {
+        if (push[i] != 0.0f) pos_x[i] = min(max(pos_x[i] + push[i], 0.0f), right_x);
+    }
+}
+
+void Crowd::PushOut(const Collision::Box& box) {
+    const float right_x = Settings::WORLD_WIDTH - width;
+    grid.Query(box, hits);
+    for (uint32_t i : hits) {
+        bool left = pos_x[i] + 0.5f * width < box.x + 0.5f * box.w;
+        pos_x[i] = min(max(left ? box.x - width : box.x + box.w, 0.0f), right_x);
+    }
+}
+
+uint64_t Crowd::Hash(uint64_t hash) const {
+    size_t n = Size();
+    const size_t n_bones = rig.Bones();
+    hash_weight.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        hash_weight[i] = limb_blend[i] * limb_amplitude[i];
+    }
+    hash_poses.resize(n * n_bones);
+    Animation::EvaluateWalk(limb_timer.data(), hash_weight.data(), n, hash_poses.data());
+
+    for (size_t i = 0; i < n; i++) {
+        hash = StateHash::Mix(hash, pos_x[i]);
+        hash = StateHash::Mix(hash, pos_y[i]);
+        hash = StateHash::Mix(hash, vel_x[i]);
+        hash = StateHash::Mix(hash, vel_y[i]);
+        hash = StateHash::Mix(hash, static_cast<uint32_t>(on_ground[i]));
+        for (size_t b = 0; b < n_bones; b++) {
+            hash = StateHash::Mix(hash, hash_poses[i * n_bones + b]);
+        }
+    }
+    return hash;
+}
+
+CrowdKernels::Arrays Crowd::Arrays() {
+    return {
+        pos_x.data(), pos_y.data(),
+        vel_x.data(), vel_y.data(),
+        acc_x.data(), acc_y.data(),
+        limb_timer.data(), limb_speed.data(), limb_blend.data(),
+        time_since_left_ground.data(), on_ground.data(),
+    };
+}
+
+void Crowd::Store(size_t i, Character& character) const {
+    character.position = {pos_x[i], pos_y[i]};
+    character.velocity = {vel_x[i], vel_y[i]};
+    character.acceleration = {acc_x[i], acc_y[i]};
+    character.limb_animation_timer = limb_timer[i];
+    character.limb_animation_speed = limb_speed[i];
+    character.limb_rotation_amplitude = limb_amplitude[i];
+    character.limb_animation_blend = limb_blend[i];
+    character.time_since_left_ground = time_since_left_ground[i];
+    character.time_since_jump_pressed = time_since_jump_pressed[i];
+    character.on_ground = on_ground[i];
+}
+
+void Crowd::Render(SpriteBatch& batch, const Poses& previous, const Poses& current, const Collision::Box& view, float alpha) const {
+    // Same reach as Character::InView
+    const float reach = max(width, height);
+    size_t n = current.x.size();
+    render_visible.clear();
+    render_x.clear();
+    render_y.clear();
+    for (size_t i = 0; i < n; i++) {
+        float x = previous.x[i] + (current.x[i] - previous.x[i]) * alpha;
+        float y = Screen::h - (previous.y[i] + (current.y[i] - previous.y[i]) * alpha + height * 0.5f);
+        if (!Collision::Overlaps(view, {x - reach, y - reach, 2.0f * reach, 2.0f * reach})) continue;
+        render_visible.push_back(static_cast<uint32_t>(i));
+        render_x.push_back(x);
+        render_y.push_back(y);
+    }
+
+    // Only the visible members are animated
+    size_t n_visible = render_visible.size();
+    render_phase.resize(n_visible);
+    render_weight.resize(n_visible);
+    for (size_t v = 0; v < n_visible; v++) {
+        uint32_t i = render_visible[v];
+        render_phase[v] = previous.limb_phase[i] + (current.limb_phase[i] - previous.limb_phase[i]) * alpha;
+        render_weight[v] = previous.limb_weight[i] + (current.limb_weight[i] - previous.limb_weight[i]) * alpha;
+    }
+    const size_t n_bones = rig.Bones();
+    render_poses.resize(n_visible * n_bones);
+    Animation::EvaluateWalk(render_phase.data(), render_weight.data(), n_visible, render_poses.data());
+
+    array<Textures::Region, 6> regions;
+    for (size_t part = 0; part < regions.size(); part++) {
+        regions[part] = *textures[part];
+    }
+    for (size_t v = 0; v < n_visible; v++) {
+        rig.Submit(batch, regions.data(), &render_poses[v * n_bones], render_x[v], render_y[v],
+            current.flip_x[render_visible[v]], Layers::Crowd, 0);
+    }
+}
@@ -0,0 +1,154 @@
+#include <crowd_kernels.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CROWD_KERNELS_X86 1
+#endif
+
+#include <settings.hpp>
+
+using namespace std;
+
+void CrowdKernels::UpdateScalar(const Arrays& a, size_t begin, size_t end, const Params& p) {
+    const float dt = p.dt;
+    const float floor_y = Settings::SCR_HEIGHT - p.height;
+    const float right_x = Settings::WORLD_WIDTH - p.width;
+
+    for (size_t i = begin; i < end; i++) {
+        a.acc_y[i] += Settings::GRAVITYPX;
+
+        a.vel_x[i] += a.acc_x[i] * dt;
+        a.vel_y[i] += a.acc_y[i] * dt;
+        a.pos_x[i] += a.vel_x[i] * dt;
+        a.pos_y[i] += a.vel_y[i] * dt;
+        a.acc_y[i] = 0.0f;
+
+        if (abs(a.vel_x[i]) < Settings::EPSILON) a.vel_x[i] = 0.0f;
+
+        if (a.vel_x[i] != 0.0f) {
+            a.limb_timer[i] += dt * a.limb_speed[i] * (a.vel_x[i] * 3 / Settings::MAX_SPEED);
+            a.limb_blend[i] = 1.0f;
+        } else {
+            a.limb_blend[i] = max(a.limb_blend[i] - dt * 2.0f, 0.0f);
+        }
+
+        if (a.pos_y[i] + p.height >= Settings::SCR_HEIGHT) {
+            a.pos_y[i] = floor_y;
+            a.vel_y[i] = 0.0f;
+            if (!a.on_ground[i]) {
+                a.on_ground[i] = 1;
+                a.time_since_left_ground[i] = -1.0f;
+            }
+        } else {
+            if (a.on_ground[i]) a.time_since_left_ground[i] = 0.0f;
+            a.on_ground[i] = 0;
+        }
+
+        if (a.pos_x[i] <= 0.0f) {
+            a.pos_x[i] = 0.0f;
+            a.vel_x[i] = 0.0f;
+        } else if (a.pos_x[i] + p.width >= Settings::WORLD_WIDTH) {
+            a.pos_x[i] = right_x;
+            a.vel_x[i] = 0.0f;
+        }
+    }
+}
+
+#ifdef CROWD_KERNELS_X86
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 size_t CrowdKernels::UpdateAvx2(const Arrays& a, size_t begin, size_t end, const Params& p) {
+    if (!Avx2Supported()) return begin;
+
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 gravity = _mm256_set1_ps(Settings::GRAVITYPX);
+    const __m256 epsilon = _mm256_set1_ps(Settings::EPSILON);
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 max_speed = _mm256_set1_ps(Settings::MAX_SPEED);
+    const __m256 blend_step = _mm256_set1_ps(p.dt * 2.0f);
+    const __m256 height = _mm256_set1_ps(p.height);
+    const __m256 width = _mm256_set1_ps(p.width);
+    const __m256 scr_height = _mm256_set1_ps(static_cast<float>(Settings::SCR_HEIGHT));
+    const __m256 world_width = _mm256_set1_ps(Settings::WORLD_WIDTH);
+    const __m256 floor_y = _mm256_set1_ps(Settings::SCR_HEIGHT - p.height);
+    const __m256 right_x = _mm256_set1_ps(Settings::WORLD_WIDTH - p.width);
+    const __m256 left_ground = _mm256_set1_ps(0.0f);
+    const __m256 landed = _mm256_set1_ps(-1.0f);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 acc_x = _mm256_loadu_ps(a.acc_x + i);
+        __m256 acc_y = _mm256_add_ps(_mm256_loadu_ps(a.acc_y + i), gravity);
+
+        __m256 vel_x = _mm256_add_ps(_mm256_loadu_ps(a.vel_x + i), _mm256_mul_ps(acc_x, dt));
+        __m256 vel_y = _mm256_add_ps(_mm256_loadu_ps(a.vel_y + i), _mm256_mul_ps(acc_y, dt));
+        __m256 pos_x = _mm256_add_ps(_mm256_loadu_ps(a.pos_x + i), _mm256_mul_ps(vel_x, dt));
+        __m256 pos_y = _mm256_add_ps(_mm256_loadu_ps(a.pos_y + i), _mm256_mul_ps(vel_y, dt));
+        _mm256_storeu_ps(a.acc_y + i, zero);
+
+        __m256 abs_vel_x = _mm256_andnot_ps(sign_mask, vel_x);
+        vel_x = _mm256_andnot_ps(_mm256_cmp_ps(abs_vel_x, epsilon, _CMP_LT_OQ), vel_x);
+
+        // Limb animation, the timer only advances while moving
+        __m256 moving = _mm256_cmp_ps(vel_x, zero, _CMP_NEQ_UQ);
+        __m256 timer = _mm256_loadu_ps(a.limb_timer + i);
+        __m256 timer_step = _mm256_mul_ps(_mm256_mul_ps(dt, _mm256_loadu_ps(a.limb_speed + i)),
+            _mm256_div_ps(_mm256_mul_ps(vel_x, three), max_speed));
+        timer = _mm256_blendv_ps(timer, _mm256_add_ps(timer, timer_step), moving);
+        __m256 blend = _mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(a.limb_blend + i), blend_step), zero);
+        blend = _mm256_blendv_ps(blend, one, moving);
+
+        // Ground
+        __m256i on_ground_i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.on_ground + i));
+        __m256 was_on_ground = _mm256_castsi256_ps(_mm256_cmpgt_epi32(on_ground_i, _mm256_setzero_si256()));
+        __m256 grounded = _mm256_cmp_ps(_mm256_add_ps(pos_y, height), scr_height, _CMP_GE_OQ);
+        pos_y = _mm256_blendv_ps(pos_y, floor_y, grounded);
+        vel_y = _mm256_andnot_ps(grounded, vel_y);
+
+        __m256 since_left = _mm256_loadu_ps(a.time_since_left_ground + i);
+        since_left = _mm256_blendv_ps(since_left, landed, _mm256_andnot_ps(was_on_ground, grounded));
+        since_left = _mm256_blendv_ps(since_left, left_ground, _mm256_andnot_ps(grounded, was_on_ground));
+        __m256i on_ground_out = _mm256_and_si256(_mm256_castps_si256(grounded), _mm256_set1_epi32(1));
+
+        // Walls, the left wall wins like the scalar else-if
+        __m256 hit_left = _mm256_cmp_ps(pos_x, zero, _CMP_LE_OQ);
+        __m256 hit_right = _mm256_andnot_ps(hit_left, _mm256_cmp_ps(_mm256_add_ps(pos_x, width), world_width, _CMP_GE_OQ));
+        pos_x = _mm256_blendv_ps(pos_x, zero, hit_left);
+        pos_x = _mm256_blendv_ps(pos_x, right_x, hit_right);
+        vel_x = _mm256_andnot_ps(_mm256_or_ps(hit_left, hit_right), vel_x);
+
+        _mm256_storeu_ps(a.pos_x + i, pos_x);
+        _mm256_storeu_ps(a.pos_y + i, pos_y);
+        _mm256_storeu_ps(a.vel_x + i, vel_x);
+        _mm256_storeu_ps(a.vel_y + i, vel_y);
+        _mm256_storeu_ps(a.limb_timer + i, timer);
+        _mm256_storeu_ps(a.limb_blend + i, blend);
+        _mm256_storeu_ps(a.time_since_left_ground + i, since_left);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a.on_ground + i), on_ground_out);
+    }
+    return i;
+}
+
+bool CrowdKernels::Avx2Supported() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#else
+
+size_t CrowdKernels::UpdateAvx2(const Arrays&, size_t begin, size_t, const Params&) {
+    return begin;
+}
+
+bool CrowdKernels::Avx2Supported() {
+    return false;
+}
+
+#endif
@@ -13,7 +13,7 @@ namespace Mouse {
     float pos_x = 0.0f;
     float pos_y = 0.0f;
     bool visible = true;
-    unsigned int texture = 0;
+    Textures::Region texture = {0, Textures::FULL_UV};
     float size_x = 32.0f;
     float size_y = 32.0f;
 }
@@ -29,10 +29,27 @@ namespace Keys {
 namespace FrameTracker {
     float fps = 0.0f;
     int frame_count = 0;
+    unsigned long total_frames = 0;
     float fps_timer = 0.0f;
     float last_frame_time = 0.0f;
     float current_frame_time = 0.0f;
     float dt = 0.0f;
+    float worst_dt = 0.0f;
+    float alpha = 1.0f;
+}
+
+namespace RenderStats {
+    unsigned int draw_calls = 0;
+    unsigned int texture_binds = 0;
+    unsigned int sprites = 0;
+    unsigned int culled = 0;
+
+    void Reset() {
+        draw_calls = 0;
+        texture_binds = 0;
+        sprites = 0;
+        culled = 0;
+    }
 }
 
 namespace GlCallback {
@@ -71,35 +88,20 @@ namespace GlShaders {
         return shader;
     }
 
-    unsigned int CreateShaderProgram() {
-        const char* vertex_source = R"(
-            #version 330 core
-            layout (location = 0) in vec3 aPos;   // Position attribute
-            layout (location = 1) in vec2 aTexCoord; // Texture coordinate attribute
-
-            out vec2 TexCoord;
-
-            uniform mat4 model;
-            uniform mat4 projection;
-
-            void main() {
-                gl_Position = projection * model * vec4(aPos, 1.0);
-                TexCoord = aTexCoord;
-            }
-        )";
+    const char* const texture_fragment_source = R"(
+        #version 330 core
+        out vec4 FragColor;
 
-        const char* fragment_source = R"(
-            #version 330 core
-            out vec4 FragColor;
+        in vec2 TexCoord;
 
-            in vec2 TexCoord;
+        uniform sampler2D texture1;
 
-            uniform sampler2D texture1;
+        void main() {
+            FragColor = texture(texture1, TexCoord);
+        }
+    )";
 
-            void main() {
-                FragColor = texture(texture1, TexCoord);
-            }
-        )";
+    unsigned int LinkProgram(const char* vertex_source, const char* fragment_source) {
         unsigned int vertex_shader = GlShaders::CompileShader(GL_VERTEX_SHADER, vertex_source);
         if (vertex_shader == 0) {
             throw runtime_error("Failed to compile vertex shader");
@@ -134,29 +136,50 @@ namespace GlShaders {
         return shader_program;
     }
 
-    void Render(
-    glm::mat4& model, 
-    unsigned int shader_program, 
-    unsigned int texture, 
-    float x, 
-    float y, 
-    float width, 
-    float height,
-    float angle,
-    bool flip_x
-) {
-    float x_co = flip_x ? -1.0f : 1.0f;
-
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(x , y, 0.0f));
-    if (angle != 0.0f) {
-        model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 0.0f, 1.0f));
+    unsigned int CreateShaderProgram() {
+        const char* vertex_source = R"(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;   // Position attribute
+            layout (location = 1) in vec2 aTexCoord; // Texture coordinate attribute
+
+            out vec2 TexCoord;
+
+            uniform mat4 model;
+            uniform mat4 projection;
+            uniform vec4 uv_rect;  // xy offset, zw scale
+
+            void main() {
+                gl_Position = projection * model * vec4(aPos, 1.0);
+                TexCoord = uv_rect.xy + aTexCoord * uv_rect.zw;
+            }
+        )";
+        return LinkProgram(vertex_source, texture_fragment_source);
     }
-    model = glm::scale(model, glm::vec3(width * x_co, height, 1.0f));
 
-    glUniformMatrix4fv(glGetUniformLocation(shader_program, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-}
+    unsigned int CreateTileShaderProgram() {
+        const char* vertex_source = R"(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;      // Unit quad position
+            layout (location = 1) in vec2 aTexCoord; // Unit quad texture coordinate
+            layout (location = 2) in vec4 aRect;     // Per instance: center xy, size zw
+            layout (location = 3) in vec4 aUV;       // Per instance: u0 v0 u1 v1
+
+            out vec2 TexCoord;
+
+            uniform mat4 projection;
 
+            void main() {
+                gl_Position = projection * vec4(aRect.xy + aPos.xy * aRect.zw, 0.0, 1.0);
+                TexCoord = mix(aUV.xy, aUV.zw, aTexCoord);
+            }
+        )";
+        return LinkProgram(vertex_source, texture_fragment_source);
+    }
+
+    SpriteUniforms::SpriteUniforms(const ShaderProgram& shader) {
+        model = shader.GetUniform<glm::mat4>("model");
+        projection = shader.GetUniform<glm::mat4>("projection");
+        uv_rect = shader.GetUniform<glm::vec4>("uv_rect");
+        texture1 = shader.GetUniform<int>("texture1");
+    }
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include <gpu_timer.hpp>
+
+GpuTimer::GpuTimer() : current(0), last_ms(0.0) {
+    glGenQueries(N_QUERIES, queries.data());
+    pending.fill(false);
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(N_QUERIES, queries.data());
+}
+
+void GpuTimer::Begin() {
+    // Collect whatever finished since last time, oldest first.
+    for (int i = 0; i < N_QUERIES; i++) {
+        int q = (current + i) % N_QUERIES;
+        if (!pending[q]) continue;
+
+        int available = 0;
+        glGetQueryObjectiv(queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(queries[q], GL_QUERY_RESULT, &elapsed_ns);
+        last_ms = elapsed_ns / 1e6;
+        pending[q] = false;
+    }
+
+    // Still in flight after a full lap, drop it rather than wait.
+    pending[current] = false;
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::End() {
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    current = (current + 1) % N_QUERIES;
+}
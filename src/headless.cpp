@@ -0,0 +1,123 @@
+#include <headless.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#include <glad/glad.h>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef __linux__
+
+bool HeadlessContext::Supported() {
+    return true;
+}
+
+HeadlessContext::HeadlessContext() : display(nullptr), context(nullptr), surface(nullptr), FBO(0), color_buffer(0), width(0), height(0) {
+    // Prefer a display that needs no X or Wayland server at all
+    EGLDisplay egl_display = EGL_NO_DISPLAY;
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display) {
+        egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (egl_display == EGL_NO_DISPLAY) egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, nullptr, nullptr)) {
+        throw runtime_error("Failed to initialize EGL");
+    }
+    display = egl_display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) throw runtime_error("EGL has no desktop OpenGL");
+
+    // The default surface type is window, which surfaceless displays have none of
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+    EGLConfig config;
+    EGLint n_configs = 0;
+    if (!eglChooseConfig(egl_display, config_attributes, &config, 1, &n_configs) || n_configs == 0) {
+        throw runtime_error("No EGL config for OpenGL");
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    EGLContext egl_context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attributes);
+    if (egl_context == EGL_NO_CONTEXT) throw runtime_error("Failed to create an OpenGL 3.3 core EGL context");
+    context = egl_context;
+
+    // Everything is drawn into our own FBO, the surface only exists for
+    // drivers without EGL_KHR_surfaceless_context.
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+        const EGLint pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        EGLSurface pbuffer = eglCreatePbufferSurface(egl_display, config, pbuffer_attributes);
+        if (pbuffer == EGL_NO_SURFACE || !eglMakeCurrent(egl_display, pbuffer, pbuffer, egl_context)) {
+            throw runtime_error("Failed to make the EGL context current");
+        }
+        surface = pbuffer;
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    if (FBO) {
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteRenderbuffers(1, &color_buffer);
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface) eglDestroySurface(display, surface);
+    if (context) eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+void* HeadlessContext::ProcAddress(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+#else
+
+bool HeadlessContext::Supported() {
+    return false;
+}
+
+HeadlessContext::HeadlessContext() : display(nullptr), context(nullptr), surface(nullptr), FBO(0), color_buffer(0), width(0), height(0) {
+    throw runtime_error("Headless mode needs EGL, only available on Linux");
+}
+
+HeadlessContext::~HeadlessContext() {}
+
+void* HeadlessContext::ProcAddress(const char*) {
+    return nullptr;
+}
+
+#endif
+
+void HeadlessContext::CreateFramebuffer(int width, int height) {
+    this->width = width;
+    this->height = height;
+
+    glGenFramebuffers(1, &FBO);
+    glGenRenderbuffers(1, &color_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw runtime_error("Headless framebuffer incomplete");
+    }
+    glViewport(0, 0, width, height);
+}
+
+vector<unsigned char> HeadlessContext::ReadPixels() const {
+    vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
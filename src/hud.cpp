@@ -0,0 +1,235 @@
+#include <hud.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    // 5x7 glyphs, one byte per row from the top, bit 4 is the left column.
+    // Lower case is drawn as upper case, anything missing as a blank.
+    struct Glyph {
+        char c;
+        uint8_t rows[7];
+    };
+
+    const Glyph FONT[] = {
+        {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+        {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+        {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+        {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+        {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+        {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+        {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+        {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+        {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+        {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+        {'A', {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+        {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+        {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+        {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+        {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+        {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+        {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+        {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+        {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+        {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+        {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+        {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+        {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+        {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+        {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+        {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+        {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+        {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+        {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+        {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+        {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+        {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+        {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+        {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+        {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+        {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+        {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+        {',', {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}},
+        {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+        {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+        {'+', {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},
+        {'=', {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},
+        {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+        {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+        {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+        {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+        {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+    };
+
+    // Premultiplied RGBA of the solid swatches, in Hud::Swatch order
+    const uint8_t SWATCH_COLORS[][4] = {
+        {255, 255, 255, 255},
+        {80, 220, 100, 255},
+        {240, 200, 60, 255},
+        {230, 70, 60, 255},
+        {0, 0, 0, 170},
+    };
+
+    // Texture layout, one 6x8 cell per glyph or swatch
+    constexpr int CELL_W = 6;
+    constexpr int CELL_H = 8;
+    constexpr int COLUMNS = 16;
+
+    // Screen layout, in Screen::w x Screen::h units
+    constexpr float SCALE = 2.0f;
+    constexpr float MARGIN = 16.0f;
+    constexpr float PADDING = 10.0f;
+    constexpr float LINE_H = CELL_H * SCALE + 4.0f;
+    constexpr float BAR_W = 3.0f;
+    constexpr float GRAPH_H = 64.0f;
+    constexpr float GRAPH_MS = 1000.0f / 30.0f; // top of the graph
+    constexpr float TARGET_MS = 1000.0f / 60.0f;
+    constexpr float REFRESH_MS = 250.0f;
+}
+
+Hud::Hud() : texture(0), next(0), sum{}, n_summed(0), elapsed_ms(0.0f) {
+    history.fill(0.0f);
+
+    const int n_cells = N_GLYPHS + N_Swatches;
+    const int rows = (n_cells + COLUMNS - 1) / COLUMNS;
+    const int w = COLUMNS * CELL_W;
+    const int h = rows * CELL_H;
+    vector<uint8_t> pixels(static_cast<size_t>(w) * h * 4, 0);
+
+    // Cells fill from the top left, texture rows start at the bottom
+    auto cell_region = [&](int cell, int inset) -> Textures::Region {
+        int cx = (cell % COLUMNS) * CELL_W;
+        int cy = h - (cell / COLUMNS + 1) * CELL_H;
+        return {0, {
+            static_cast<float>(cx + inset) / w, static_cast<float>(cy + inset) / h,
+            static_cast<float>(cx + CELL_W - inset) / w, static_cast<float>(cy + CELL_H - inset) / h
+        }};
+    };
+    auto set = [&](int x, int y, const uint8_t* rgba) {
+        copy(rgba, rgba + 4, &pixels[(static_cast<size_t>(y) * w + x) * 4]);
+    };
+
+    for (const Glyph& glyph : FONT) {
+        int cell = glyph.c - ' ';
+        int cx = (cell % COLUMNS) * CELL_W;
+        int top = h - (cell / COLUMNS) * CELL_H - 1;
+        for (int row = 0; row < 7; row++) {
+            for (int col = 0; col < 5; col++) {
+                if (glyph.rows[row] & (0x10 >> col)) set(cx + col, top - row, SWATCH_COLORS[White]);
+            }
+        }
+    }
+    for (int s = 0; s < N_Swatches; s++) {
+        int cell = N_GLYPHS + s;
+        int cx = (cell % COLUMNS) * CELL_W;
+        int cy = h - (cell / COLUMNS + 1) * CELL_H;
+        for (int y = cy; y < cy + CELL_H; y++) {
+            for (int x = cx; x < cx + CELL_W; x++) set(x, y, SWATCH_COLORS[s]);
+        }
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    // Integer scaled pixel font, no filtering and no mips
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    for (int i = 0; i < N_GLYPHS; i++) {
+        glyphs[i] = cell_region(i, 0);
+        glyphs[i].texture = texture;
+    }
+    // Sample swatches away from their edges so stretching can't pick up a neighbour
+    for (int s = 0; s < N_Swatches; s++) {
+        swatches[s] = cell_region(N_GLYPHS + s, 2);
+        swatches[s].texture = texture;
+    }
+}
+
+Hud::~Hud() {
+    glDeleteTextures(1, &texture);
+}
+
+void Hud::Push(const Sample& sample) {
+    history[next] = sample.frame_ms;
+    next = (next + 1) % HISTORY;
+
+    sum.frame_ms += sample.frame_ms;
+    sum.tick_ms += sample.tick_ms;
+    sum.render_ms += sample.render_ms;
+    sum.gpu_ms += sample.gpu_ms;
+    n_summed++;
+    elapsed_ms += sample.frame_ms;
+    if (elapsed_ms < REFRESH_MS && !lines[0].empty()) return;
+
+    float n = static_cast<float>(n_summed);
+    char line[96];
+    snprintf(line, sizeof(line), "FPS %d  FRAME %.2f MS",
+        static_cast<int>(1000.0f / max(sum.frame_ms / n, 0.001f) + 0.5f), sum.frame_ms / n);
+    lines[0] = line;
+    if (sample.gpu_ms < 0.0f) {
+        snprintf(line, sizeof(line), "TICK %.3f MS  RENDER %.2f MS", sum.tick_ms / n, sum.render_ms / n);
+    } else {
+        snprintf(line, sizeof(line), "TICK %.3f MS  RENDER %.2f MS  GPU %.2f MS", sum.tick_ms / n, sum.render_ms / n, sum.gpu_ms / n);
+    }
+    lines[1] = line;
+    snprintf(line, sizeof(line), "DRAWS %u  BINDS %u  SPRITES %u", sample.draw_calls, sample.texture_binds, sample.sprites);
+    lines[2] = line;
+    snprintf(line, sizeof(line), "ENTITIES %zu", sample.entities);
+    lines[3] = line;
+
+    sum = {};
+    n_summed = 0;
+    elapsed_ms = 0.0f;
+}
+
+void Hud::Submit(SpriteBatch& batch) const {
+    size_t longest = 0;
+    for (const string& line : lines) longest = max(longest, line.size());
+    float text_w = longest * CELL_W * SCALE;
+    float graph_w = HISTORY * BAR_W;
+    float panel_w = max(text_w, graph_w) + PADDING * 2.0f;
+    float panel_h = N_LINES * LINE_H + GRAPH_H + PADDING * 3.0f;
+
+    float left = MARGIN;
+    float top = Screen::h - MARGIN;
+    Rect(batch, Panel, left, top - panel_h, panel_w, panel_h);
+
+    float x = left + PADDING;
+    float y = top - PADDING;
+    for (const string& line : lines) {
+        y -= LINE_H;
+        Text(batch, line, x, y);
+    }
+
+    // Oldest frame on the left, bars clipped at GRAPH_MS
+    float graph_y = top - panel_h + PADDING;
+    for (int i = 0; i < HISTORY; i++) {
+        float ms = history[(next + i) % HISTORY];
+        if (ms <= 0.0f) continue;
+        Swatch color = ms <= TARGET_MS * 1.05f ? Green : ms <= TARGET_MS * 2.0f ? Yellow : Red;
+        float bar_h = min(ms / GRAPH_MS, 1.0f) * GRAPH_H;
+        Rect(batch, color, x + i * BAR_W, graph_y, BAR_W - 1.0f, max(bar_h, 1.0f));
+    }
+    Rect(batch, White, x, graph_y + TARGET_MS / GRAPH_MS * GRAPH_H, graph_w, 1.0f);
+}
+
+void Hud::Text(SpriteBatch& batch, const string& text, float x, float y) const {
+    const float w = CELL_W * SCALE;
+    const float h = CELL_H * SCALE;
+    for (size_t i = 0; i < text.size(); i++) {
+        int c = toupper(static_cast<unsigned char>(text[i]));
+        if (c <= ' ' || c - ' ' >= N_GLYPHS) continue;
+        batch.Draw(glyphs[c - ' '], Layers::Hud, x + i * w + w / 2.0f, y + h / 2.0f, w, h, 0.0f, false);
+    }
+}
+
+void Hud::Rect(SpriteBatch& batch, Swatch swatch, float x, float y, float w, float h) const {
+    batch.Draw(swatches[swatch], Layers::Hud, x + w / 2.0f, y + h / 2.0f, w, h, 0.0f, false);
+}
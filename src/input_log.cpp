@@ -0,0 +1,95 @@
+#include <input_log.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[4] = {'I', 'N', 'P', '1'};
+
+    struct Header {
+        char magic[4];
+        uint32_t header_size;
+        float tick_rate;
+        uint32_t crowd;
+        uint32_t seed;
+        uint32_t n_records;
+        uint64_t ticks;
+        uint64_t state_hash;
+    };
+
+    // Tick then bits, unpadded
+    constexpr size_t RECORD_BYTES = sizeof(uint32_t) + sizeof(uint8_t);
+}
+
+void InputLog::Record(unsigned long tick, uint8_t bits) {
+    uint8_t last = records.empty() ? 0 : records.back().bits;
+    if (bits == last) return;
+    records.push_back({static_cast<uint32_t>(tick), bits});
+}
+
+void InputLog::Finish(unsigned long ticks, uint64_t state_hash) {
+    this->ticks = ticks;
+    this->state_hash = state_hash;
+}
+
+void InputLog::Save(const string& path) const {
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.header_size = sizeof(Header);
+    header.tick_rate = tick_rate;
+    header.crowd = crowd;
+    header.seed = seed;
+    header.n_records = static_cast<uint32_t>(records.size());
+    header.ticks = ticks;
+    header.state_hash = state_hash;
+
+    vector<uint8_t> bytes(records.size() * RECORD_BYTES);
+    for (size_t i = 0; i < records.size(); i++) {
+        memcpy(&bytes[i * RECORD_BYTES], &records[i].tick, sizeof(uint32_t));
+        bytes[i * RECORD_BYTES + sizeof(uint32_t)] = records[i].bits;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) throw runtime_error("Failed to write input log " + path);
+    bool ok = fwrite(&header, sizeof(Header), 1, file) == 1
+        && fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) throw runtime_error("Failed to write input log " + path);
+}
+
+InputLog InputLog::Load(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) throw runtime_error("Failed to open input log " + path);
+
+    Header header;
+    bool ok = fread(&header, sizeof(Header), 1, file) == 1
+        && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+        && header.header_size == sizeof(Header);
+    vector<uint8_t> bytes;
+    if (ok) {
+        bytes.resize(static_cast<size_t>(header.n_records) * RECORD_BYTES);
+        ok = fread(bytes.data(), 1, bytes.size(), file) == bytes.size() && fgetc(file) == EOF;
+    }
+    fclose(file);
+    if (!ok) throw runtime_error("Not an input log, or truncated: " + path);
+
+    InputLog log;
+    log.tick_rate = header.tick_rate;
+    log.crowd = header.crowd;
+    log.seed = header.seed;
+    log.ticks = static_cast<unsigned long>(header.ticks);
+    log.state_hash = header.state_hash;
+    log.records.resize(header.n_records);
+    for (size_t i = 0; i < log.records.size(); i++) {
+        memcpy(&log.records[i].tick, &bytes[i * RECORD_BYTES], sizeof(uint32_t));
+        log.records[i].bits = bytes[i * RECORD_BYTES + sizeof(uint32_t)];
+    }
+    return log;
+}
+
+uint8_t InputLog::At(unsigned long tick) const {
+    // Ticks only move forward, so the cursor only does too
+    while (cursor < records.size() && records[cursor].tick <= tick) cursor++;
+    return cursor == 0 ? 0 : records[cursor - 1].bits;
+}
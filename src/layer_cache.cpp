@@ -0,0 +1,45 @@
+#include <layer_cache.hpp>
+
+LayerCache::LayerCache() : color_texture(0), width(0), height(0), saved_framebuffer(0), valid(false) {
+    glGenFramebuffers(1, &FBO);
+}
+
+LayerCache::~LayerCache() {
+    glDeleteFramebuffers(1, &FBO);
+    if (color_texture) glDeleteTextures(1, &color_texture);
+}
+
+void LayerCache::Begin(int width, int height) {
+    glGetIntegerv(GL_VIEWPORT, saved_viewport);
+    // Not necessarily 0, headless mode renders into its own FBO
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &saved_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+    if (width != this->width || height != this->height) {
+        if (color_texture) glDeleteTextures(1, &color_texture);
+        glGenTextures(1, &color_texture);
+        glBindTexture(GL_TEXTURE_2D, color_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_texture, 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw runtime_error("Layer cache framebuffer incomplete");
+        }
+        this->width = width;
+        this->height = height;
+    }
+
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void LayerCache::End() {
+    glBindFramebuffer(GL_FRAMEBUFFER, saved_framebuffer);
+    glViewport(saved_viewport[0], saved_viewport[1], saved_viewport[2], saved_viewport[3]);
+    valid = true;
+}
@@ -0,0 +1,168 @@
+#include <profiler.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include <glad/glad.h>
+
+namespace Profiler {
+    bool enabled = false;
+
+    namespace {
+        // Seqlock per slot: odd while a writer is filling it, 2 * (index + 1)
+        // once event index is complete. Readers skip slots that don't match.
+        struct Slot {
+            atomic<uint64_t> sequence{0};
+            Event event;
+        };
+        constexpr size_t CAPACITY = 1 << 16;
+        array<Slot, CAPACITY> ring;
+        atomic<uint64_t> head{0};
+
+        constexpr size_t MAX_THREADS = 16;
+        array<atomic<const char*>, MAX_THREADS> thread_names{};
+        atomic<uint32_t> n_threads{0};
+        thread_local int32_t thread_index = -1;
+
+        uint32_t ThreadIndex() {
+            if (thread_index < 0) {
+                thread_index = static_cast<int32_t>(min<uint32_t>(n_threads.fetch_add(1), MAX_THREADS - 1));
+            }
+            return static_cast<uint32_t>(thread_index);
+        }
+
+        void Push(const Event& event) {
+            uint64_t index = head.fetch_add(1, memory_order_relaxed);
+            Slot& slot = ring[index & (CAPACITY - 1)];
+            slot.sequence.store(2 * index + 1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+            slot.event = event;
+            slot.sequence.store(2 * (index + 1), memory_order_release);
+        }
+
+        struct GpuPass {
+            const char* name;
+            unsigned int queries[2];
+        };
+        vector<unsigned int> free_queries;
+        deque<GpuPass> gpu_passes;
+        vector<GpuPass*> open_passes;
+        int64_t gpu_offset_ns = 0;
+        bool gpu_calibrated = false;
+
+        vector<double> frame_samples;
+    }
+
+    int64_t Now() {
+        static const auto epoch = chrono::steady_clock::now();
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+    }
+
+    void SetThreadName(const char* name) {
+        thread_names[ThreadIndex()] = name;
+    }
+
+    void Record(const char* name, int64_t start_ns, int64_t duration_ns) {
+        Push({name, start_ns, duration_ns, ThreadIndex()});
+    }
+
+    void BeginGpu(const char* name) {
+        if (!enabled) return;
+        if (!gpu_calibrated) {
+            // Maps GPU timestamps onto Now(), good to the latency of one query
+            GLint64 gpu_now;
+            glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+            gpu_offset_ns = Now() - gpu_now;
+            gpu_calibrated = true;
+        }
+
+        GpuPass pass = {name, {0, 0}};
+        for (unsigned int& query : pass.queries) {
+            if (free_queries.empty()) {
+                glGenQueries(1, &query);
+            } else {
+                query = free_queries.back();
+                free_queries.pop_back();
+            }
+        }
+        glQueryCounter(pass.queries[0], GL_TIMESTAMP);
+        gpu_passes.push_back(pass);
+        open_passes.push_back(&gpu_passes.back());
+    }
+
+    void EndGpu() {
+        if (open_passes.empty()) return;
+        glQueryCounter(open_passes.back()->queries[1], GL_TIMESTAMP);
+        open_passes.pop_back();
+    }
+
+    void CollectGpu() {
+        // Passes finish in submission order, stop at the first one still in flight
+        while (gpu_passes.size() > open_passes.size()) {
+            GpuPass& pass = gpu_passes.front();
+            GLint available = 0;
+            glGetQueryObjectiv(pass.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 start, end;
+            glGetQueryObjectui64v(pass.queries[0], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(pass.queries[1], GL_QUERY_RESULT, &end);
+            Push({pass.name, static_cast<int64_t>(start) + gpu_offset_ns, static_cast<int64_t>(end - start), GPU_THREAD});
+
+            free_queries.push_back(pass.queries[0]);
+            free_queries.push_back(pass.queries[1]);
+            gpu_passes.pop_front();
+        }
+    }
+
+    void FrameDone(double frame_ms) {
+        if (enabled) frame_samples.push_back(frame_ms);
+    }
+
+    Bench::Stats FrameStats() {
+        return Bench::Summarize(frame_samples);
+    }
+
+    vector<Event> Events() {
+        vector<Event> events;
+        uint64_t end = head.load(memory_order_acquire);
+        uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        events.reserve(end - begin);
+        for (uint64_t index = begin; index < end; index++) {
+            const Slot& slot = ring[index & (CAPACITY - 1)];
+            uint64_t before = slot.sequence.load(memory_order_acquire);
+            Event event = slot.event;
+            atomic_thread_fence(memory_order_acquire);
+            if (before != 2 * (index + 1) || slot.sequence.load(memory_order_relaxed) != before) continue;
+            events.push_back(event);
+        }
+        sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.start_ns < b.start_ns; });
+        return events;
+    }
+
+    void WriteChromeTrace(const string& path) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) throw runtime_error("Failed to open " + path);
+
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", GPU_THREAD);
+        uint32_t threads = min<uint32_t>(n_threads.load(), MAX_THREADS);
+        for (uint32_t i = 0; i < threads; i++) {
+            const char* name = thread_names[i].load();
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                i, name ? name : "thread");
+        }
+        for (const Event& event : Events()) {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, event.thread, event.start_ns / 1000.0, event.duration_ns / 1000.0);
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+    }
+}
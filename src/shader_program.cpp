@@ -0,0 +1,54 @@
+#include <shader_program.hpp>
+
+#include <vector>
+
+ShaderProgram::ShaderProgram(unsigned int program) : id(program) {
+    if (id == 0) throw runtime_error("ShaderProgram needs a linked program");
+
+    int count = 0;
+    int max_length = 0;
+    vector<char> name;
+
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    name.resize(max_length + 1);
+    for (int i = 0; i < count; i++) {
+        int size;
+        GLenum type;
+        GLsizei length;
+        glGetActiveUniform(id, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+
+        // Arrays are reported as "name[0]", callers ask for "name".
+        string key(name.data(), length);
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0) key.resize(key.size() - 3);
+        uniforms[key] = {glGetUniformLocation(id, name.data()), type};
+    }
+
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+    name.resize(max_length + 1);
+    for (int i = 0; i < count; i++) {
+        int size;
+        GLenum type;
+        GLsizei length;
+        glGetActiveAttrib(id, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        attributes[string(name.data(), length)] = {glGetAttribLocation(id, name.data()), type};
+    }
+}
+
+ShaderProgram::~ShaderProgram() {
+    glDeleteProgram(id);
+}
+
+void ShaderProgram::Use() const {
+    glUseProgram(id);
+}
+
+ShaderProgram::Attribute ShaderProgram::GetAttribute(const string& name) const {
+    auto it = attributes.find(name);
+    if (it == attributes.end()) {
+        cerr << "Shader attribute not found: " << name << "\n";
+        return {};
+    }
+    return it->second;
+}
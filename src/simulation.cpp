@@ -0,0 +1,145 @@
+#include <simulation.hpp>
+
+#include <algorithm>
+
+#include <profiler.hpp>
+
+Simulation::Simulation(Character& player, Crowd& crowd, float tick_dt)
+    : player(player), crowd(crowd), tick_dt(tick_dt), epoch(chrono::steady_clock::now()),
+      next_tick(0.0), ticks(0), running(false), last_tick_ms(0.0f), replay_done(false), run_hash(StateHash::OFFSET) {
+    player_last = player.CurrentPose(false, false);
+    crowd.StorePoses(crowd_last);
+
+    // The renderer needs something to draw before the first tick
+    FrameSnapshot& first = snapshots.Back();
+    first.player_previous = first.player_current = player_last;
+    first.crowd_previous = first.crowd_current = crowd_last;
+    first.tick_time = 0.0;
+    first.tick = 0;
+    snapshots.Publish();
+}
+
+Simulation::~Simulation() {
+    Stop();
+}
+
+void Simulation::Start() {
+    if (running) return;
+    running = true;
+    next_tick = Now();
+    worker = thread(&Simulation::Run, this);
+}
+
+void Simulation::Stop() {
+    if (!running) return;
+    running = false;
+    worker.join();
+}
+
+double Simulation::Now() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - epoch).count();
+}
+
+void Simulation::Run() {
+    Profiler::SetThreadName("simulation");
+    while (running) {
+        Advance(Now());
+        this_thread::sleep_until(epoch + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(next_tick)));
+    }
+}
+
+void Simulation::Advance(double now) {
+    next_tick = max(next_tick, now - Settings::MAX_FRAME_TIME);
+    while (next_tick <= now) {
+        Tick();
+        next_tick += tick_dt;
+    }
+}
+
+void Simulation::Tick() {
+    PROFILE_SCOPE("tick");
+    auto start = chrono::steady_clock::now();
+    if (replay && ticks >= replay->Ticks()) {
+        replay_done.store(true, memory_order_release);
+        return;
+    }
+
+    uint8_t bits;
+    if (replay) {
+        bits = replay->At(ticks);
+    } else {
+        bits = (input.move_left.load(memory_order_relaxed) ? InputLog::MoveLeft : 0)
+            | (input.move_right.load(memory_order_relaxed) ? InputLog::MoveRight : 0)
+            | (input.jump.exchange(false) ? InputLog::Jump : 0)
+            | (input.sprint.load(memory_order_relaxed) ? InputLog::Sprint : 0);
+    }
+    if (record) record->Record(ticks, bits);
+
+    bool move_left = bits & InputLog::MoveLeft;
+    bool move_right = bits & InputLog::MoveRight;
+    if (bits & InputLog::Jump) {
+        player.time_since_jump_pressed = 0.0;
+    }
+
+    {
+        PROFILE_SCOPE("move");
+        player.Move(move_left, move_right, bits & InputLog::Sprint);
+        player.UpdateTimes(tick_dt);
+
+        if (player.time_since_jump_pressed >= 0.0) {
+            player.Jump();
+        }
+    }
+    {
+        PROFILE_SCOPE("update");
+        player.Update(tick_dt);
+    }
+    {
+        PROFILE_SCOPE("crowd");
+        crowd.Step(tick_dt);
+    }
+    if (collide) {
+        PROFILE_SCOPE("collide");
+        crowd.Collide();
+        // Update already flagged the world edges
+        if (crowd.Touches(player.Bounds())) {
+            player.is_colliding = true;
+            crowd.PushOut(player.Bounds());
+        }
+        crowd.Separate();
+    }
+    if (hash) {
+        PROFILE_SCOPE("hash");
+        uint64_t tick_hash = CurrentHash();
+        run_hash = StateHash::Mix(run_hash, tick_hash);
+        if (hash_log) hash_log->Write(ticks, tick_hash);
+    }
+    ticks++;
+
+    FrameSnapshot& snapshot = snapshots.Back();
+    snapshot.player_previous = player_last;
+    snapshot.player_current = player.CurrentPose(move_right, move_left);
+    swap(snapshot.crowd_previous, crowd_last);
+    crowd.StorePoses(snapshot.crowd_current);
+    snapshot.tick_time = next_tick;
+    snapshot.tick = ticks;
+
+    player_last = snapshot.player_current;
+    crowd_last = snapshot.crowd_current;
+    snapshots.Publish();
+    last_tick_ms.store(chrono::duration<float, milli>(chrono::steady_clock::now() - start).count(), memory_order_relaxed);
+}
+
+const FrameSnapshot& Simulation::Latest() {
+    snapshots.Update();
+    return snapshots.Front();
+}
+
+float Simulation::Alpha(const FrameSnapshot& snapshot, double now) const {
+    float alpha = static_cast<float>((now - snapshot.tick_time) / tick_dt);
+    return min(max(alpha, 0.0f), 1.0f);
+}
+
+uint64_t Simulation::CurrentHash() const {
+    return crowd.Hash(player.Hash(StateHash::OFFSET));
+}
@@ -0,0 +1,208 @@
+#include <sprite_batch.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+SpriteBatch::SpriteBatch(const ShaderProgram& shader, size_t initial_sprites) : shader(shader), uniforms(shader) {
+    capacity = 0;
+    ring_bytes = 0;
+    head = 0;
+    stalls = 0;
+    cull = false;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    Reserve(initial_sprites);
+    glBindVertexArray(0);
+}
+
+SpriteBatch::~SpriteBatch() {
+    ReleaseFences();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+void SpriteBatch::Reserve(size_t n_sprites) {
+    if (n_sprites <= capacity) return;
+    while (capacity < n_sprites) {
+        capacity = capacity ? capacity * 2 : n_sprites;
+    }
+
+    // Quads share one static index pattern, only the vertex data streams.
+    vector<unsigned int> indices(capacity * 6);
+    for (size_t i = 0; i < capacity; i++) {
+        unsigned int base = static_cast<unsigned int>(i * 4);
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 3;
+        indices[i * 6 + 3] = base + 1;
+        indices[i * 6 + 4] = base + 2;
+        indices[i * 6 + 5] = base + 3;
+    }
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    // Fresh storage, nothing in flight can touch it
+    ring_bytes = capacity * 4 * sizeof(Vertex) * RING_BATCHES;
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, ring_bytes, NULL, GL_STREAM_DRAW);
+    ReleaseFences();
+    head = 0;
+}
+
+void SpriteBatch::ReleaseFences() {
+    for (Fence& fence : fences) glDeleteSync(fence.sync);
+    fences.clear();
+}
+
+void SpriteBatch::Begin() {
+    quads.clear();
+    keys.clear();
+}
+
+void SpriteBatch::Draw(
+    const Textures::Region& region,
+    int layer,
+    float x,
+    float y,
+    float width,
+    float height,
+    float angle,
+    bool flip_x
+) {
+    Draw(region, layer, x, y, width, height,
+        angle == 0.0f ? QuadTransform::IDENTITY : QuadTransform::Rotation::Degrees(angle), flip_x);
+}
+
+void SpriteBatch::Draw(
+    const Textures::Region& region,
+    int layer,
+    float x,
+    float y,
+    float width,
+    float height,
+    QuadTransform::Rotation rotation,
+    bool flip_x
+) {
+    if (cull) {
+        // Half the extents' sum is at least half the diagonal, so this holds
+        // at any rotation
+        float reach = 0.5f * (abs(width) + abs(height));
+        if (x + reach < view_x0 || x - reach > view_x1 || y + reach < view_y0 || y - reach > view_y1) {
+            RenderStats::culled++;
+            return;
+        }
+    }
+
+    keys.push_back({layer, region.texture, static_cast<unsigned int>(quads.size())});
+    quads.push_back({x, y, (flip_x ? -0.5f : 0.5f) * width, 0.5f * height, rotation, region.uv});
+}
+
+void SpriteBatch::SetView(float x0, float y0, float x1, float y1) {
+    cull = true;
+    view_x0 = x0;
+    view_y0 = y0;
+    view_x1 = x1;
+    view_y1 = y1;
+}
+
+void SpriteBatch::ClearView() {
+    cull = false;
+}
+
+void SpriteBatch::End() {
+    if (keys.empty()) return;
+
+    // The index breaks ties, so this keeps submission order for sprites
+    // sharing a layer and texture like a stable sort would.
+    sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) return a.texture < b.texture;
+        return a.index < b.index;
+    });
+
+    Reserve(keys.size());
+
+    size_t bytes = keys.size() * 4 * sizeof(Vertex);
+    if (head + bytes > ring_bytes) head = 0;
+
+    // Fences signal in submission order and the ring is written in order, so
+    // only the oldest ones can cover the range about to be written.
+    while (!fences.empty()) {
+        const Fence& fence = fences.front();
+        bool overlaps = fence.begin < head + bytes && head < fence.end;
+        GLenum status = glClientWaitSync(fence.sync, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            if (!overlaps) break;
+            stalls++;
+            do {
+                status = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence.sync);
+        fences.pop_front();
+    }
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    Vertex* mapped = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, head, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+    if (!mapped) throw runtime_error("Failed to map the sprite vertex buffer");
+    for (size_t i = 0; i < keys.size(); i++) {
+        const Quad& quad = quads[keys[i].index];
+        // Same corner order as TileLayer's unit quad
+        QuadTransform::Point corners[4];
+        if (quad.rotation.Identity()) {
+            QuadTransform::Corners(quad.x, quad.y, quad.half_w, quad.half_h, corners);
+        } else {
+            QuadTransform::Corners(quad.x, quad.y, quad.half_w, quad.half_h, quad.rotation, corners);
+        }
+        const Textures::UVRect& uv = quad.uv;
+        Vertex* vertices = mapped + i * 4;
+        vertices[0] = {corners[0].x, corners[0].y, 0.0f, uv.u1, uv.v1}; // Top Right
+        vertices[1] = {corners[1].x, corners[1].y, 0.0f, uv.u1, uv.v0}; // Bottom Right
+        vertices[2] = {corners[2].x, corners[2].y, 0.0f, uv.u0, uv.v0}; // Bottom Left
+        vertices[3] = {corners[3].x, corners[3].y, 0.0f, uv.u0, uv.v1}; // Top Left
+    }
+    // False only if the storage was lost (e.g. a display mode change), which
+    // costs one garbled batch at worst.
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    GLint base_vertex = static_cast<GLint>(head / sizeof(Vertex));
+
+    shader.Use();
+    shader.Set(uniforms.model, glm::mat4(1.0f));
+    // Atlas coordinates are already baked into the vertices.
+    shader.Set(uniforms.uv_rect, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    // One draw per run of consecutive sprites with the same texture.
+    size_t run_start = 0;
+    for (size_t i = 1; i <= keys.size(); i++) {
+        if (i < keys.size() && keys[i].texture == keys[run_start].texture) continue;
+
+        glBindTexture(GL_TEXTURE_2D, keys[run_start].texture);
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>((i - run_start) * 6), GL_UNSIGNED_INT,
+            (void*)(run_start * 6 * sizeof(unsigned int)), base_vertex);
+        RenderStats::texture_binds++;
+        RenderStats::draw_calls++;
+        run_start = i;
+    }
+    RenderStats::sprites += static_cast<unsigned int>(keys.size());
+
+    fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), head, head + bytes});
+    head += bytes;
+
+    glBindVertexArray(0);
+}
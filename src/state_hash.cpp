@@ -0,0 +1,104 @@
+#include <state_hash.hpp>
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[4] = {'H', 'S', 'H', '1'};
+
+    struct Record {
+        uint64_t tick;
+        uint64_t hash;
+    };
+
+    unique_ptr<FILE, int (*)(FILE*)> OpenLog(const string& path) {
+        unique_ptr<FILE, int (*)(FILE*)> file(fopen(path.c_str(), "rb"), fclose);
+        char magic[4];
+        if (!file || fread(magic, sizeof(magic), 1, file.get()) != 1 || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw runtime_error("Not a state hash log: " + path);
+        }
+        return file;
+    }
+}
+
+StateHash::Log::Log(const string& path) : path(path) {
+    file = fopen(path.c_str(), "wb");
+    if (!file) throw runtime_error("Failed to write state hash log " + path);
+    if (fwrite(MAGIC, sizeof(MAGIC), 1, file) != 1) {
+        fclose(file);
+        throw runtime_error("Failed to write state hash log " + path);
+    }
+}
+
+StateHash::Log::~Log() {
+    if (file) fclose(file);
+}
+
+void StateHash::Log::Write(unsigned long tick, uint64_t hash) {
+    if (failed) return;
+    Record record = {tick, hash};
+    failed = fwrite(&record, sizeof(Record), 1, file) != 1;
+}
+
+void StateHash::Log::Close() {
+    if (!file) return;
+    bool ok = (fclose(file) == 0) && !failed;
+    file = nullptr;
+    if (!ok) throw runtime_error("Failed to write state hash log " + path);
+}
+
+StateHash::Comparison StateHash::Compare(const string& path_a, const string& path_b) {
+    auto a = OpenLog(path_a);
+    auto b = OpenLog(path_b);
+
+    Comparison result = {0, false, 0, 0, 0, 0, 0};
+    Record record_a, record_b;
+    bool more_a = fread(&record_a, sizeof(Record), 1, a.get()) == 1;
+    bool more_b = fread(&record_b, sizeof(Record), 1, b.get()) == 1;
+    while (more_a && more_b) {
+        if (record_a.tick != record_b.tick) throw runtime_error("State hash logs " + path_a + " and " + path_b + " are out of step");
+        if (record_a.hash != record_b.hash) {
+            result.diverged = true;
+            result.tick = static_cast<unsigned long>(record_a.tick);
+            result.hash_a = record_a.hash;
+            result.hash_b = record_b.hash;
+            break;
+        }
+        result.compared++;
+        more_a = fread(&record_a, sizeof(Record), 1, a.get()) == 1;
+        more_b = fread(&record_b, sizeof(Record), 1, b.get()) == 1;
+    }
+
+    // Lengths are only worth counting when the shared part matched
+    if (!result.diverged) {
+        result.length_a = result.compared + (more_a ? 1 : 0);
+        result.length_b = result.compared + (more_b ? 1 : 0);
+        while (more_a && fread(&record_a, sizeof(Record), 1, a.get()) == 1) result.length_a++;
+        while (more_b && fread(&record_b, sizeof(Record), 1, b.get()) == 1) result.length_b++;
+    }
+    return result;
+}
+
+int StateHash::Report(const string& path_a, const string& path_b) {
+    Comparison result = Compare(path_a, path_b);
+    if (result.diverged) {
+        cout << "First divergence at tick " << result.tick << " (" << path_a << " " << Hex(result.hash_a) << ", "
+             << path_b << " " << Hex(result.hash_b) << ") after " << result.compared << " matching ticks\n";
+        return 1;
+    }
+    cout << "Identical over " << result.compared << " ticks";
+    if (result.length_a != result.length_b) {
+        cout << ", but one run is longer (" << path_a << " " << result.length_a << ", " << path_b << " "
+             << result.length_b << ")\n";
+        return 1;
+    }
+    cout << "\n";
+    return 0;
+}
+
+string StateHash::Hex(uint64_t hash) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return string(buffer);
+}
@@ -0,0 +1,123 @@
+#include <texture_atlas.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <numeric>
+
+TextureAtlas::TextureAtlas(int page_size, int padding) : page_size(page_size), padding(padding), built(false) {}
+
+TextureAtlas::~TextureAtlas() {
+    glDeleteTextures(static_cast<GLsizei>(pages.size()), pages.data());
+}
+
+bool TextureAtlas::Add(const Image& image) {
+    if (built) throw runtime_error("Atlas already built, can't add: " + image.path);
+    for (auto& entry : entries) {
+        if (entry.image.path == image.path) return true;
+    }
+
+    if (image.w + padding * 2 > page_size || image.h + padding * 2 > page_size) return false;
+
+    entries.push_back({image, -1, 0, 0});
+    return true;
+}
+
+void TextureAtlas::Build() {
+    if (built) return;
+    built = true;
+
+    // Shelf packing, tallest first keeps the shelves tight.
+    vector<size_t> order(entries.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].image.h > entries[b].image.h; });
+
+    struct Page {
+        int used_w, used_h;
+    };
+    vector<Page> page_dims;
+    int cursor_x = 0, shelf_y = 0, shelf_h = 0;
+    for (size_t i : order) {
+        Entry& entry = entries[i];
+        int w = entry.image.w + padding * 2;
+        int h = entry.image.h + padding * 2;
+
+        if (page_dims.empty() || cursor_x + w > page_size) {
+            shelf_y += shelf_h;
+            cursor_x = 0;
+            shelf_h = 0;
+        }
+        if (page_dims.empty() || shelf_y + h > page_size) {
+            page_dims.push_back({0, 0});
+            cursor_x = 0;
+            shelf_y = 0;
+            shelf_h = 0;
+        }
+
+        entry.page = static_cast<int>(page_dims.size()) - 1;
+        entry.x = cursor_x;
+        entry.y = shelf_y;
+        cursor_x += w;
+        shelf_h = max(shelf_h, h);
+
+        Page& page = page_dims.back();
+        page.used_w = max(page.used_w, cursor_x);
+        page.used_h = max(page.used_h, shelf_y + h);
+    }
+
+    pages.resize(page_dims.size());
+    glGenTextures(static_cast<GLsizei>(pages.size()), pages.data());
+
+    for (size_t p = 0; p < pages.size(); p++) {
+        int pw = page_dims[p].used_w;
+        int ph = page_dims[p].used_h;
+        vector<unsigned char> pixels(static_cast<size_t>(pw) * ph * 4, 0);
+
+        for (auto& entry : entries) {
+            if (entry.page != static_cast<int>(p)) continue;
+            const Image& image = entry.image;
+            const unsigned char* data = image.pixels.get();
+
+            // Copy the image and extrude its border into the padding so
+            // filtering and the smaller mip levels don't bleed neighbours in.
+            for (int y = -padding; y < image.h + padding; y++) {
+                int sy = min(max(y, 0), image.h - 1);
+                for (int x = -padding; x < image.w + padding; x++) {
+                    int sx = min(max(x, 0), image.w - 1);
+                    size_t dst = (static_cast<size_t>(entry.y + padding + y) * pw + (entry.x + padding + x)) * 4;
+                    size_t src = (static_cast<size_t>(sy) * image.w + sx) * 4;
+                    memcpy(&pixels[dst], &data[src], 4);
+                }
+            }
+
+            float u0 = static_cast<float>(entry.x + padding) / pw;
+            float v0 = static_cast<float>(entry.y + padding) / ph;
+            float u1 = static_cast<float>(entry.x + padding + image.w) / pw;
+            float v1 = static_cast<float>(entry.y + padding + image.h) / ph;
+            regions[image.path] = {pages[p], {u0, v0, u1, v1}};
+
+            entry.image.pixels.reset();
+        }
+
+        glBindTexture(GL_TEXTURE_2D, pages[p]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pw, ph, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        // Past log2(padding) the mip levels would mix neighbouring sprites.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(log2(max(padding, 1))));
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+}
+
+bool TextureAtlas::Contains(const string& path) const {
+    return regions.find(path) != regions.end();
+}
+
+Textures::Region TextureAtlas::Find(const string& path) const {
+    auto it = regions.find(path);
+    if (it == regions.end()) throw runtime_error("Texture not in atlas: " + path);
+    return it->second;
+}
@@ -0,0 +1,117 @@
+#include <texture_cache.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TextureCache {
+    bool enabled = true;
+    string directory = ".texture_cache";
+    atomic<int> hits(0);
+
+    namespace {
+        const char MAGIC[4] = {'T', 'X', 'C', '1'};
+
+        struct Header {
+            char magic[4];
+            uint32_t header_size;
+            int64_t source_mtime;
+            uint64_t source_size;
+            int32_t w;
+            int32_t h;
+        };
+
+        string CachePath(const string& path) {
+            string name = path;
+            for (char& c : name) {
+                if (c == '/' || c == '\\' || c == ':') c = '_';
+            }
+            return directory + "/" + name + ".rgba";
+        }
+
+        bool SourceStat(const string& path, int64_t& mtime, uint64_t& size) {
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) return false;
+            mtime = static_cast<int64_t>(st.st_mtime);
+            size = static_cast<uint64_t>(st.st_size);
+            return true;
+        }
+    }
+
+    bool Load(const string& path, Image& image) {
+        if (!enabled) return false;
+
+        int64_t mtime;
+        uint64_t size;
+        if (!SourceStat(path, mtime, size)) return false;
+
+        int fd = open(CachePath(path).c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            return false;
+        }
+        size_t length = static_cast<size_t>(st.st_size);
+        void* mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        Header header;
+        memcpy(&header, mapping, sizeof(Header));
+        size_t pixel_bytes = static_cast<size_t>(header.w) * header.h * 4;
+        bool fresh = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+            && header.header_size == sizeof(Header)
+            && header.source_mtime == mtime
+            && header.source_size == size
+            && header.w > 0 && header.h > 0
+            && length == sizeof(Header) + pixel_bytes;
+        if (!fresh) {
+            munmap(mapping, length);
+            return false;
+        }
+
+        image.path = path;
+        image.w = header.w;
+        image.h = header.h;
+        // The mapping lives as long as the pixels are referenced.
+        unsigned char* pixels = static_cast<unsigned char*>(mapping) + sizeof(Header);
+        image.pixels = shared_ptr<unsigned char>(pixels, [mapping, length](unsigned char*) { munmap(mapping, length); });
+        hits++;
+        return true;
+    }
+
+    void Store(const string& path, const Image& image) {
+        if (!enabled) return;
+
+        Header header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.header_size = sizeof(Header);
+        if (!SourceStat(path, header.source_mtime, header.source_size)) return;
+        header.w = image.w;
+        header.h = image.h;
+
+        mkdir(directory.c_str(), 0755);
+
+        // Write then rename, so a reader never maps a half written entry.
+        string final_path = CachePath(path);
+        string temp_path = final_path + ".tmp" + to_string(getpid());
+        FILE* file = fopen(temp_path.c_str(), "wb");
+        if (!file) return;
+
+        size_t pixel_bytes = static_cast<size_t>(image.w) * image.h * 4;
+        bool ok = fwrite(&header, sizeof(Header), 1, file) == 1
+            && fwrite(image.pixels.get(), 1, pixel_bytes, file) == pixel_bytes;
+        ok = (fclose(file) == 0) && ok;
+
+        if (!ok || rename(temp_path.c_str(), final_path.c_str()) != 0) {
+            remove(temp_path.c_str());
+        }
+    }
+}
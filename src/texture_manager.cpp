@@ -0,0 +1,68 @@
+#include <texture_manager.hpp>
+
+#include <stdexcept>
+
+TextureManager::~TextureManager() {
+    // Atlas pages are deleted by the atlas itself
+    for (auto& entry : entries) {
+        if (entry.second.standalone) glDeleteTextures(1, &entry.second.region.texture);
+    }
+}
+
+void TextureManager::Add(const Image& image) {
+    if (entries.count(image.path)) return;
+    if (atlas.Add(image)) return;
+
+    entries[image.path] = {{UploadTexture(image), Textures::FULL_UV}, true, {}};
+    uploads++;
+}
+
+void TextureManager::Build() {
+    if (built) return;
+    built = true;
+
+    size_t pages = atlas.Pages();
+    atlas.Build();
+    uploads += atlas.Pages() - pages;
+}
+
+TextureHandle TextureManager::Acquire(const string& path) {
+    if (!built) throw runtime_error("TextureManager::Build must be called before Acquire: " + path);
+
+    auto it = entries.find(path);
+    if (it == entries.end()) {
+        Entry entry;
+        if (atlas.Contains(path)) {
+            entry = {atlas.Find(path), false, {}};
+        } else {
+            entry = {{UploadTexture(DecodeImage(path)), Textures::FULL_UV}, true, {}};
+            uploads++;
+        }
+        it = entries.emplace(path, entry).first;
+    }
+
+    if (TextureHandle handle = it->second.handle.lock()) return handle;
+
+    TextureHandle handle(new Textures::Region(it->second.region), [this, path](const Textures::Region* region) {
+        Release(path, region);
+    });
+    it->second.handle = handle;
+    return handle;
+}
+
+void TextureManager::Release(const string& path, const Textures::Region* region) {
+    delete region;
+
+    auto it = entries.find(path);
+    if (it == entries.end() || !it->second.standalone) return;
+    glDeleteTextures(1, &it->second.region.texture);
+    entries.erase(it);
+}
+
+size_t TextureManager::Live() const {
+    size_t live = 0;
+    for (auto& entry : entries) {
+        if (!entry.second.handle.expired()) live++;
+    }
+    return live;
+}
@@ -0,0 +1,84 @@
+#include <tile_layer.hpp>
+
+TileLayer::TileLayer() : texture(0), capacity(0) {
+    float vertices[] = {
+        // positions        // texture coords
+         0.5f,  0.5f, 0.0f,   1.0f, 1.0f, // Top Right
+         0.5f, -0.5f, 0.0f,   1.0f, 0.0f, // Bottom Right
+        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, // Bottom Left
+        -0.5f,  0.5f, 0.0f,   0.0f, 1.0f  // Top Left
+    };
+    unsigned int indices[] = {
+        0, 1, 3,  // First Triangle
+        1, 2, 3   // Second Triangle
+    };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &quad_VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &instance_VBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quad_VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+}
+
+TileLayer::~TileLayer() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &quad_VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &instance_VBO);
+}
+
+void TileLayer::Build(const vector<Instance>& tiles, unsigned int texture) {
+    instances = tiles;
+    this->texture = texture;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+    if (instances.size() > capacity) {
+        capacity = instances.size();
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), instances.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+    }
+}
+
+void TileLayer::Draw() const {
+    if (instances.empty()) return;
+
+    glBindVertexArray(VAO);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(instances.size()));
+    RenderStats::texture_binds++;
+    RenderStats::draw_calls++;
+    RenderStats::sprites += static_cast<unsigned int>(instances.size());
+    glBindVertexArray(0);
+}
+
+void TileLayer::Submit(SpriteBatch& batch, int layer) const {
+    for (auto& tile : instances) {
+        batch.Draw({texture, tile.uv}, layer, tile.x, tile.y, tile.w, tile.h, 0.0f, false);
+    }
+}
@@ -0,0 +1,185 @@
+#include <tile_map.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gl_util.hpp>
+#include <sprite_batch.hpp>
+#include <settings.hpp>
+
+namespace {
+    const char MAGIC[4] = {'T', 'M', 'P', '1'};
+
+    struct Header {
+        char magic[4];
+        uint32_t header_size;
+        uint32_t chunk_size;
+        uint32_t n_layers;
+    };
+
+    struct LayerRecord {
+        int32_t texture;
+        int32_t sprite_layer;
+        float tile_size;
+        float origin_x;
+        float origin_y;
+        int32_t chunks_x;
+        int32_t chunks_y;
+    };
+
+    int ChunksFor(float extent, float tile_size) {
+        int n_tiles = static_cast<int>(extent / tile_size) + 1;
+        return (n_tiles + TileMap::CHUNK_SIZE - 1) / TileMap::CHUNK_SIZE;
+    }
+}
+
+TileMap::TileMap(const vector<Layer>& layers) : layers(layers) {
+    for (const Layer& layer : layers) {
+        if (layer.chunks_x < 1 || layer.chunks_y < 1 || !(layer.tile_size > 0.0f)) throw runtime_error("Invalid tile map layer");
+        offsets.push_back(n_tiles);
+        n_tiles += static_cast<size_t>(layer.chunks_x) * layer.chunks_y * CHUNK_TILES;
+    }
+    auto owned = make_shared<vector<uint16_t>>(n_tiles, 0);
+    tiles = shared_ptr<uint16_t>(owned, owned->data());
+}
+
+TileMap TileMap::Generate(float width) {
+    float ground = Textures::TextureLoads.at(Textures::Ground).dim.w;
+    float floor_size = Textures::TextureLoads.at(Textures::Floor).dim.w;
+    float shadow = Textures::TextureLoads.at(Textures::GroundShawow).dim.w;
+    // Ground fills up to the floor, which overlaps it by a quarter tile,
+    // with the shadow sitting on the floor's edge
+    int ground_rows = static_cast<int>((Settings::MIN_GROUND_Y - ground) / ground) + 1;
+    TileMap map({
+        {Textures::Ground, Layers::Ground, ground, 0.0f, 0.0f, ChunksFor(width, ground), 1},
+        {Textures::Floor, Layers::Floor, floor_size, 0.0f, Settings::MIN_GROUND_Y - floor_size * 0.75f, ChunksFor(width, floor_size), 1},
+        {Textures::GroundShawow, Layers::GroundShadow, shadow, 0.0f, Settings::MIN_GROUND_Y, ChunksFor(width, shadow), 1},
+    });
+
+    const int rows[] = {ground_rows, 1, 1};
+    for (size_t layer = 0; layer < map.LayerCount(); layer++) {
+        int columns = static_cast<int>(width / map.layers[layer].tile_size) + 1;
+        for (int y = 0; y < rows[layer]; y++) {
+            for (int x = 0; x < columns; x++) {
+                map.Set(layer, x, y, 1);
+            }
+        }
+    }
+    return map;
+}
+
+TileMap TileMap::Load(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("Failed to open tile map " + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        throw runtime_error("Not a tile map: " + path);
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    // Private and writable, so Set works on a loaded map without touching the file
+    void* mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) throw runtime_error("Failed to map tile map " + path);
+    shared_ptr<uint16_t> guard(nullptr, [mapping, length](uint16_t*) { munmap(mapping, length); });
+
+    const char* bytes = static_cast<const char*>(mapping);
+    Header header;
+    memcpy(&header, bytes, sizeof(Header));
+    size_t ids_at = sizeof(Header) + static_cast<size_t>(header.n_layers) * sizeof(LayerRecord);
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.header_size != sizeof(Header)
+        || header.chunk_size != CHUNK_SIZE || ids_at > length) {
+        throw runtime_error("Not a tile map: " + path);
+    }
+
+    vector<Layer> layers;
+    for (uint32_t i = 0; i < header.n_layers; i++) {
+        LayerRecord record;
+        memcpy(&record, bytes + sizeof(Header) + i * sizeof(LayerRecord), sizeof(LayerRecord));
+        layers.push_back({record.texture, record.sprite_layer, record.tile_size,
+            record.origin_x, record.origin_y, record.chunks_x, record.chunks_y});
+    }
+
+    TileMap map;
+    map.layers = layers;
+    for (const Layer& layer : layers) {
+        if (layer.chunks_x < 1 || layer.chunks_y < 1 || !(layer.tile_size > 0.0f)
+            || layer.texture < 0 || layer.texture >= Textures::N_Textures) {
+            throw runtime_error("Invalid tile map layer in " + path);
+        }
+        map.offsets.push_back(map.n_tiles);
+        map.n_tiles += static_cast<size_t>(layer.chunks_x) * layer.chunks_y * CHUNK_TILES;
+    }
+    if (ids_at + map.n_tiles * sizeof(uint16_t) != length) throw runtime_error("Truncated tile map " + path);
+
+    // The ids alias the mapping, which lives as long as the map does
+    map.tiles = shared_ptr<uint16_t>(guard, reinterpret_cast<uint16_t*>(static_cast<char*>(mapping) + ids_at));
+    return map;
+}
+
+void TileMap::Save(const string& path) const {
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.header_size = sizeof(Header);
+    header.chunk_size = CHUNK_SIZE;
+    header.n_layers = static_cast<uint32_t>(layers.size());
+
+    // Write then rename, like TextureCache::Store
+    string temp_path = path + ".tmp" + to_string(getpid());
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if (!file) throw runtime_error("Failed to write tile map " + path);
+
+    bool ok = fwrite(&header, sizeof(Header), 1, file) == 1;
+    for (const Layer& layer : layers) {
+        LayerRecord record = {layer.texture, layer.sprite_layer, layer.tile_size,
+            layer.origin_x, layer.origin_y, layer.chunks_x, layer.chunks_y};
+        ok = ok && fwrite(&record, sizeof(LayerRecord), 1, file) == 1;
+    }
+    ok = ok && fwrite(tiles.get(), sizeof(uint16_t), n_tiles, file) == n_tiles;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(temp_path.c_str(), path.c_str()) != 0) {
+        remove(temp_path.c_str());
+        throw runtime_error("Failed to write tile map " + path);
+    }
+}
+
+uint16_t TileMap::Get(size_t layer, int x, int y) const {
+    const Layer& l = layers[layer];
+    if (x < 0 || y < 0 || x >= l.chunks_x * CHUNK_SIZE || y >= l.chunks_y * CHUNK_SIZE) return 0;
+    return Chunk(layer, x / CHUNK_SIZE, y / CHUNK_SIZE)[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE];
+}
+
+void TileMap::Set(size_t layer, int x, int y, uint16_t id) {
+    const Layer& l = layers[layer];
+    if (x < 0 || y < 0 || x >= l.chunks_x * CHUNK_SIZE || y >= l.chunks_y * CHUNK_SIZE) throw runtime_error("Tile out of range");
+    uint16_t* chunk = tiles.get() + offsets[layer] + (static_cast<size_t>(y / CHUNK_SIZE) * l.chunks_x + x / CHUNK_SIZE) * CHUNK_TILES;
+    chunk[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] = id;
+}
+
+const uint16_t* TileMap::Chunk(size_t layer, int chunk_x, int chunk_y) const {
+    const Layer& l = layers[layer];
+    return tiles.get() + offsets[layer] + (static_cast<size_t>(chunk_y) * l.chunks_x + chunk_x) * CHUNK_TILES;
+}
+
+TileMap::ChunkRange TileMap::Overlapping(size_t layer, float x0, float y0, float x1, float y1) const {
+    const Layer& l = layers[layer];
+    // Tiles are centered on their coordinates, so shift by half a tile
+    float chunk = l.tile_size * CHUNK_SIZE;
+    auto first = [&](float v, float origin) { return static_cast<int>(floor((v - origin + l.tile_size * 0.5f) / chunk)); };
+    return {
+        max(first(x0, l.origin_x), 0),
+        max(first(y0, l.origin_y), 0),
+        min(first(x1, l.origin_x) + 1, l.chunks_x),
+        min(first(y1, l.origin_y) + 1, l.chunks_y),
+    };
+}
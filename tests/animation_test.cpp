@@ -0,0 +1,77 @@
+#include "test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <animation.hpp>
+
+TEST(CurveHitsItsKeys) {
+    for (const Animation::Curve& track : Animation::Walk().tracks) {
+        for (const Animation::Key& key : track.keys) {
+            CHECK(abs(track.Sample(key.time) - key.value) < 1e-6f);
+            CHECK(abs(track.Sample(key.time + 3.0f) - key.value) < 1e-5f);
+        }
+    }
+    CHECK(Animation::Curve().Sample(0.3f) == 0.0f);
+}
+
+TEST(CurveMaxSecondDerivative) {
+    // The walk's tracks are +-sin built from Hermite segments, steeper at
+    // the keys than sin's 4 pi^2
+    float sine = 0.0f;
+    for (const Animation::Curve& track : Animation::Walk().tracks) sine = max(sine, track.MaxSecondDerivative());
+    CHECK(abs(sine - (6.0f - static_cast<float>(M_PI)) * 16.0f) < 1e-3f);
+
+    // Against finite differences of the curve itself
+    const Animation::Curve& track = Animation::Walk().tracks[2];
+    const float h = 1e-3f;
+    float measured = 0.0f;
+    for (int i = 1; i < 1000; i++) {
+        float t = i / 1000.0f;
+        float d2 = (track.Sample(t + h) - 2.0f * track.Sample(t) + track.Sample(t - h)) / (h * h);
+        measured = max(measured, abs(d2));
+    }
+    CHECK(measured <= track.MaxSecondDerivative() * 1.01f);
+    CHECK(measured >= track.MaxSecondDerivative() * 0.9f);
+}
+
+TEST(TableMatchesItsCurveWithinTheBound) {
+    const Animation::Clip& clip = Animation::Walk();
+    for (int resolution : {16, 64, 256}) {
+        Animation::Table table(clip, resolution);
+        CHECK(table.Bones() == clip.tracks.size());
+
+        float curvature = 0.0f;
+        for (const Animation::Curve& track : clip.tracks) curvature = max(curvature, track.MaxSecondDerivative());
+        const float weight = 45.0f;
+        float bound = weight * curvature / (8.0f * resolution * resolution) + 1e-4f;
+
+        mt19937 rng(resolution);
+        uniform_real_distribution<float> phase_dist(-50.0f, 50.0f);
+        const size_t n = 5000;
+        vector<float> phase(n), weights(n, weight);
+        for (auto& p : phase) p = phase_dist(rng);
+        vector<float> curves(n * table.Bones()), poses(n * table.Bones());
+        Animation::Evaluate(clip, phase.data(), weights.data(), n, curves.data());
+        table.Evaluate(phase.data(), weights.data(), n, poses.data());
+
+        float worst = 0.0f;
+        for (size_t i = 0; i < poses.size(); i++) worst = max(worst, abs(poses[i] - curves[i]));
+        CHECK(worst <= bound);
+    }
+    CHECK_THROWS(Animation::Table(clip, 0));
+}
+
+TEST(RotationTableMatchesSinCos) {
+    const Animation::RotationTable& table = Animation::Rotations();
+    float worst = 0.0f;
+    for (int i = -20000; i <= 20000; i++) {
+        float degrees = i * 0.0371f;
+        QuadTransform::Rotation expected = QuadTransform::Rotation::Degrees(degrees);
+        QuadTransform::Rotation looked_up = table.Degrees(degrees);
+        worst = max({worst, abs(looked_up.sin - expected.sin), abs(looked_up.cos - expected.cos)});
+    }
+    CHECK(worst < 2e-6f);
+    CHECK(table.Degrees(0.0f).Identity());
+}
@@ -0,0 +1,112 @@
+#include "test.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include <collision.hpp>
+
+namespace {
+    vector<Collision::Pair> Sorted(vector<Collision::Pair> pairs) {
+        sort(pairs.begin(), pairs.end(), [](const Collision::Pair& l, const Collision::Pair& r) {
+            return l.a != r.a ? l.a < r.a : l.b < r.b;
+        });
+        return pairs;
+    }
+
+    bool Same(const vector<Collision::Pair>& expected, const vector<Collision::Pair>& found) {
+        vector<Collision::Pair> sorted = Sorted(found);
+        return expected.size() == sorted.size() && equal(expected.begin(), expected.end(), sorted.begin(),
+            [](const Collision::Pair& l, const Collision::Pair& r) { return l.a == r.a && l.b == r.b; });
+    }
+
+    // Goblin sized boxes dense enough for plenty of overlaps
+    vector<Collision::Box> RandomBoxes(size_t n, mt19937& rng) {
+        uniform_real_distribution<float> position(-500.0f, 2500.0f);
+        uniform_real_distribution<float> size(20.0f, 200.0f);
+        vector<Collision::Box> boxes(n);
+        for (auto& box : boxes) box = {position(rng), position(rng), size(rng), size(rng)};
+        return boxes;
+    }
+}
+
+TEST(OverlapsIgnoresTouchingEdges) {
+    CHECK(Collision::Overlaps({0.0f, 0.0f, 10.0f, 10.0f}, {5.0f, 5.0f, 10.0f, 10.0f}));
+    CHECK(!Collision::Overlaps({0.0f, 0.0f, 10.0f, 10.0f}, {10.0f, 0.0f, 10.0f, 10.0f}));
+    CHECK(!Collision::Overlaps({0.0f, 0.0f, 10.0f, 10.0f}, {0.0f, 10.0f, 10.0f, 10.0f}));
+}
+
+TEST(SpatialHashPairsMatchBruteForce) {
+    mt19937 rng(1234);
+    vector<Collision::Box> boxes = RandomBoxes(2000, rng);
+    vector<Collision::Pair> expected, found;
+    Collision::BruteForcePairs(boxes.data(), boxes.size(), expected);
+    CHECK(!expected.empty());
+
+    Collision::SpatialHash grid(160.0f);
+    for (size_t i = 0; i < boxes.size(); i++) grid.Update(static_cast<uint32_t>(i), boxes[i]);
+    CHECK(grid.Size() == boxes.size());
+    grid.Pairs(found);
+    CHECK(Same(expected, found));
+}
+
+TEST(SpatialHashIncrementalUpdatesMatchBruteForce) {
+    mt19937 rng(99);
+    vector<Collision::Box> boxes = RandomBoxes(1000, rng);
+    Collision::SpatialHash grid(160.0f);
+    for (size_t i = 0; i < boxes.size(); i++) grid.Update(static_cast<uint32_t>(i), boxes[i]);
+
+    // Small steps mostly keep a box's cells, large ones relink it
+    uniform_real_distribution<float> step(-40.0f, 40.0f);
+    vector<Collision::Pair> expected, found;
+    for (int tick = 0; tick < 20; tick++) {
+        for (size_t i = 0; i < boxes.size(); i++) {
+            boxes[i].x += step(rng);
+            boxes[i].y += step(rng);
+            grid.Update(static_cast<uint32_t>(i), boxes[i]);
+        }
+        Collision::BruteForcePairs(boxes.data(), boxes.size(), expected);
+        grid.Pairs(found);
+        CHECK(Same(expected, found));
+    }
+}
+
+TEST(SpatialHashRemoveAndQuery) {
+    mt19937 rng(7);
+    vector<Collision::Box> boxes = RandomBoxes(500, rng);
+    Collision::SpatialHash grid(100.0f);
+    for (size_t i = 0; i < boxes.size(); i++) grid.Update(static_cast<uint32_t>(i), boxes[i]);
+
+    // Drop every other box, the rest must still pair exactly like brute force
+    vector<Collision::Box> kept;
+    vector<uint32_t> ids;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (i % 2) {
+            grid.Remove(static_cast<uint32_t>(i));
+        } else {
+            kept.push_back(boxes[i]);
+            ids.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    CHECK(grid.Size() == kept.size());
+
+    vector<Collision::Pair> expected, found;
+    Collision::BruteForcePairs(kept.data(), kept.size(), expected);
+    for (auto& pair : expected) pair = {ids[pair.a], ids[pair.b]};
+    grid.Pairs(found);
+    CHECK(Same(expected, found));
+
+    Collision::Box probe = {900.0f, 900.0f, 300.0f, 300.0f};
+    vector<uint32_t> hits;
+    grid.Query(probe, hits);
+    sort(hits.begin(), hits.end());
+    vector<uint32_t> overlapping;
+    for (size_t k = 0; k < kept.size(); k++) {
+        if (Collision::Overlaps(probe, kept[k])) overlapping.push_back(ids[k]);
+    }
+    CHECK(hits == overlapping);
+
+    grid.Clear();
+    CHECK(grid.Size() == 0);
+    grid.Pairs(found);
+    CHECK(found.empty());
+}
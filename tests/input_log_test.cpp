@@ -0,0 +1,73 @@
+#include "test.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+#include <input_log.hpp>
+
+TEST(InputLogRecordsChangesOnly) {
+    InputLog log;
+    log.Record(0, 0);
+    log.Record(1, InputLog::MoveRight);
+    log.Record(2, InputLog::MoveRight);
+    log.Record(3, InputLog::MoveRight | InputLog::Jump);
+    log.Record(4, InputLog::MoveRight);
+    log.Record(5, 0);
+    CHECK(log.Records() == 4);
+
+    CHECK(log.At(0) == 0);
+    CHECK(log.At(1) == InputLog::MoveRight);
+    CHECK(log.At(2) == InputLog::MoveRight);
+    CHECK(log.At(3) == (InputLog::MoveRight | InputLog::Jump));
+    CHECK(log.At(4) == InputLog::MoveRight);
+    CHECK(log.At(100) == 0);
+}
+
+TEST(InputLogSaveLoadRoundTrip) {
+    InputLog log;
+    log.tick_rate = 120.0f;
+    log.crowd = 1000;
+    log.seed = 42;
+    for (unsigned long tick = 0; tick < 500; tick++) {
+        log.Record(tick, static_cast<uint8_t>((tick / 7) % 16));
+    }
+    log.Finish(500, 0x0123456789abcdefull);
+    string path = Test::TempPath("round_trip.inp");
+    log.Save(path);
+
+    InputLog loaded = InputLog::Load(path);
+    CHECK(loaded.tick_rate == 120.0f);
+    CHECK(loaded.crowd == 1000);
+    CHECK(loaded.seed == 42);
+    CHECK(loaded.Ticks() == 500);
+    CHECK(loaded.StateHash() == 0x0123456789abcdefull);
+    CHECK(loaded.Records() == log.Records());
+    for (unsigned long tick = 0; tick < 500; tick++) {
+        CHECK(loaded.At(tick) == (tick / 7) % 16);
+    }
+}
+
+TEST(InputLogRejectsBadFiles) {
+    CHECK_THROWS(InputLog::Load(Test::TempPath("missing.inp")));
+
+    InputLog log;
+    log.Record(3, InputLog::Jump);
+    log.Finish(10, 1);
+    string path = Test::TempPath("truncated.inp");
+    log.Save(path);
+    // Cut the last record short
+    FILE* file = fopen(path.c_str(), "rb");
+    CHECK(file);
+    vector<char> bytes(4096);
+    size_t size = fread(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+    file = fopen(path.c_str(), "wb");
+    fwrite(bytes.data(), 1, size - 1, file);
+    fclose(file);
+    CHECK_THROWS(InputLog::Load(path));
+
+    file = fopen(path.c_str(), "wb");
+    fputs("not an input log at all, just some text", file);
+    fclose(file);
+    CHECK_THROWS(InputLog::Load(path));
+}
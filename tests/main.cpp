@@ -0,0 +1,42 @@
+#include "test.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+namespace {
+    set<string> temp_paths;
+}
+
+vector<Test::Case>& Test::Cases() {
+    static vector<Case> cases;
+    return cases;
+}
+
+void Test::Fail(const char* file, int line, const string& condition) {
+    throw runtime_error(string(file) + ":" + to_string(line) + ": CHECK(" + condition + ") failed");
+}
+
+string Test::TempPath(const string& name) {
+    string path = "character_tests_" + name;
+    temp_paths.insert(path);
+    return path;
+}
+
+int main() {
+    int failed = 0;
+    for (const Test::Case& test : Test::Cases()) {
+        try {
+            test.run();
+            cout << "ok   " << test.name << "\n";
+        } catch (const exception& error) {
+            cout << "FAIL " << test.name << "\n     " << error.what() << "\n";
+            failed++;
+        }
+    }
+    for (const string& path : temp_paths) remove(path.c_str());
+
+    cout << Test::Cases().size() - failed << " passed, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#include "test.hpp"
+
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <quad_transform.hpp>
+
+// The corners SpriteBatch writes against translate * rotate * scale of the
+// unit quad, the matrix path sprites used to take
+TEST(QuadTransformMatchesTheMatrixPath) {
+    const float unit[4][2] = {{0.5f, 0.5f}, {0.5f, -0.5f}, {-0.5f, -0.5f}, {-0.5f, 0.5f}};
+    mt19937 rng(1234);
+    uniform_real_distribution<float> position(-2000.0f, 2000.0f);
+    uniform_real_distribution<float> size(1.0f, 500.0f);
+    uniform_real_distribution<float> angle(-360.0f, 360.0f);
+
+    for (int i = 0; i < 10000; i++) {
+        float x = position(rng), y = position(rng), w = size(rng), h = size(rng);
+        float degrees = i % 3 == 0 ? 0.0f : angle(rng);
+        bool flip_x = i % 2 != 0;
+
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(x, y, 0.0f));
+        if (degrees != 0.0f) model = glm::rotate(model, glm::radians(degrees), glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, glm::vec3(w * (flip_x ? -1.0f : 1.0f), h, 1.0f));
+
+        QuadTransform::Rotation rotation = degrees == 0.0f ? QuadTransform::IDENTITY : QuadTransform::Rotation::Degrees(degrees);
+        float half_w = (flip_x ? -0.5f : 0.5f) * w;
+        QuadTransform::Point corners[4];
+        if (rotation.Identity()) {
+            QuadTransform::Corners(x, y, half_w, 0.5f * h, corners);
+        } else {
+            QuadTransform::Corners(x, y, half_w, 0.5f * h, rotation, corners);
+        }
+
+        for (int c = 0; c < 4; c++) {
+            glm::vec4 p = model * glm::vec4(unit[c][0], unit[c][1], 0.0f, 1.0f);
+            CHECK(abs(corners[c].x - p.x) <= 1e-3f);
+            CHECK(abs(corners[c].y - p.y) <= 1e-3f);
+        }
+    }
+}
+
+TEST(QuadTransformRotationInverse) {
+    QuadTransform::Rotation rotation = QuadTransform::Rotation::Degrees(30.0f);
+    QuadTransform::Rotation inverse = rotation.Inverse();
+    CHECK(abs(inverse.sin + 0.5f) < 1e-6f);
+    CHECK(inverse.cos == rotation.cos);
+    CHECK(QuadTransform::IDENTITY.Identity());
+    CHECK(!rotation.Identity());
+}
@@ -0,0 +1,70 @@
+#include "test.hpp"
+
+#include <stdexcept>
+
+#include <state_hash.hpp>
+
+namespace {
+    // One run's hashes, diverging from tick `diverge` on if it's in range
+    void WriteRun(const string& path, unsigned long ticks, unsigned long diverge = ~0ul) {
+        StateHash::Log log(path);
+        for (unsigned long tick = 0; tick < ticks; tick++) {
+            uint64_t hash = StateHash::Mix(StateHash::OFFSET, static_cast<uint64_t>(tick));
+            if (tick >= diverge) hash = StateHash::Mix(hash, 1.0f);
+            log.Write(tick, hash);
+        }
+        log.Close();
+    }
+}
+
+TEST(StateHashMixSeesEveryBit) {
+    uint64_t zero = StateHash::Mix(StateHash::OFFSET, 0.0f);
+    CHECK(zero != StateHash::Mix(StateHash::OFFSET, -0.0f));
+    CHECK(zero != StateHash::Mix(StateHash::OFFSET, 1e-45f));
+    // Order matters
+    uint64_t ab = StateHash::Mix(StateHash::Mix(StateHash::OFFSET, 1.0f), 2.0f);
+    uint64_t ba = StateHash::Mix(StateHash::Mix(StateHash::OFFSET, 2.0f), 1.0f);
+    CHECK(ab != ba);
+    CHECK(StateHash::Hex(0x00ab) == "00000000000000ab");
+}
+
+TEST(StateHashCompareIdenticalRuns) {
+    string a = Test::TempPath("a.hsh"), b = Test::TempPath("b.hsh");
+    WriteRun(a, 300);
+    WriteRun(b, 300);
+    StateHash::Comparison result = StateHash::Compare(a, b);
+    CHECK(!result.diverged);
+    CHECK(result.compared == 300);
+    CHECK(result.length_a == 300 && result.length_b == 300);
+}
+
+TEST(StateHashCompareFindsTheFirstDivergence) {
+    string a = Test::TempPath("a.hsh"), b = Test::TempPath("b.hsh");
+    WriteRun(a, 300);
+    WriteRun(b, 300, 123);
+    StateHash::Comparison result = StateHash::Compare(a, b);
+    CHECK(result.diverged);
+    CHECK(result.tick == 123);
+    CHECK(result.compared == 123);
+    CHECK(result.hash_a != result.hash_b);
+}
+
+TEST(StateHashCompareReportsLengths) {
+    string a = Test::TempPath("a.hsh"), b = Test::TempPath("b.hsh");
+    WriteRun(a, 300);
+    WriteRun(b, 250);
+    StateHash::Comparison result = StateHash::Compare(a, b);
+    CHECK(!result.diverged);
+    CHECK(result.compared == 250);
+    CHECK(result.length_a == 300 && result.length_b == 250);
+}
+
+TEST(StateHashCompareRejectsOtherFiles) {
+    string a = Test::TempPath("a.hsh"), other = Test::TempPath("other.hsh");
+    WriteRun(a, 10);
+    FILE* file = fopen(other.c_str(), "wb");
+    fputs("HSH0 not a hash log", file);
+    fclose(file);
+    CHECK_THROWS(StateHash::Compare(a, other));
+    CHECK_THROWS(StateHash::Compare(a, Test::TempPath("missing.hsh")));
+}
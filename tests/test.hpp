@@ -0,0 +1,47 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Just enough of a test harness for the CPU-only modules. TEST defines a case
+// that registers itself, CHECK throws out of it on the first failed condition
+// and main runs every case, exiting nonzero if any failed.
+namespace Test {
+    struct Case {
+        const char* name;
+        void (*run)();
+    };
+    vector<Case>& Cases();
+
+    struct Register {
+        Register(const char* name, void (*run)()) { Cases().push_back({name, run}); }
+    };
+
+    [[noreturn]] void Fail(const char* file, int line, const string& condition);
+
+    // A path in the working directory for files a case writes, removed on exit
+    string TempPath(const string& name);
+}
+
+#define TEST(name) \
+    static void name(); \
+    static Test::Register name##_register(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+// Passes if expression throws runtime_error
+#define CHECK_THROWS(expression) \
+    do { \
+        bool threw = false; \
+        try { expression; } catch (const runtime_error&) { threw = true; } \
+        if (!threw) Test::Fail(__FILE__, __LINE__, "throws: " #expression); \
+    } while (0)
+
+#endif // TEST_HPP
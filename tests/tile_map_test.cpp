@@ -0,0 +1,72 @@
+#include "test.hpp"
+
+#include <stdexcept>
+
+#include <tile_map.hpp>
+#include <gl_util.hpp>
+#include <sprite_batch.hpp>
+
+namespace {
+    bool SameTiles(const TileMap& a, const TileMap& b) {
+        if (a.LayerCount() != b.LayerCount()) return false;
+        for (size_t layer = 0; layer < a.LayerCount(); layer++) {
+            const TileMap::Layer& la = a.GetLayer(layer);
+            const TileMap::Layer& lb = b.GetLayer(layer);
+            if (la.texture != lb.texture || la.sprite_layer != lb.sprite_layer || la.tile_size != lb.tile_size
+                || la.origin_x != lb.origin_x || la.origin_y != lb.origin_y
+                || la.chunks_x != lb.chunks_x || la.chunks_y != lb.chunks_y) {
+                return false;
+            }
+            for (int y = 0; y < la.chunks_y * TileMap::CHUNK_SIZE; y++) {
+                for (int x = 0; x < la.chunks_x * TileMap::CHUNK_SIZE; x++) {
+                    if (a.Get(layer, x, y) != b.Get(layer, x, y)) return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST(TileMapSaveLoadRoundTrip) {
+    TileMap map = TileMap::Generate(4000.0f);
+    CHECK(map.LayerCount() == 3);
+    // Scatter ids across chunk boundaries
+    const TileMap::Layer& ground = map.GetLayer(0);
+    int width = ground.chunks_x * TileMap::CHUNK_SIZE, height = ground.chunks_y * TileMap::CHUNK_SIZE;
+    for (int i = 0; i < 200; i++) {
+        map.Set(0, (i * 37) % width, (i * 13) % height, static_cast<uint16_t>(i + 2));
+    }
+    CHECK_THROWS(map.Set(0, width, 0, 1));
+    string path = Test::TempPath("round_trip.tmap");
+    map.Save(path);
+
+    TileMap loaded = TileMap::Load(path);
+    CHECK(SameTiles(map, loaded));
+    CHECK(loaded.Get(0, -1, 0) == 0);
+    CHECK(loaded.Get(0, 0, 1 << 20) == 0);
+}
+
+TEST(TileMapOverlappingClampsToTheLayer) {
+    TileMap map({{Textures::Ground, Layers::Ground, 10.0f, 0.0f, 0.0f, 4, 2}});
+    // Chunks are 320 units, tiles centered on their coordinates
+    TileMap::ChunkRange all = map.Overlapping(0, -1000.0f, -1000.0f, 100000.0f, 100000.0f);
+    CHECK(all.x0 == 0 && all.y0 == 0 && all.x1 == 4 && all.y1 == 2);
+    TileMap::ChunkRange one = map.Overlapping(0, 400.0f, 10.0f, 500.0f, 20.0f);
+    CHECK(one.x0 == 1 && one.x1 == 2 && one.y0 == 0 && one.y1 == 1);
+}
+
+TEST(TileMapRejectsBadFiles) {
+    CHECK_THROWS(TileMap::Load(Test::TempPath("missing.tmap")));
+
+    // A layer naming a texture that doesn't exist
+    TileMap bad({{Textures::N_Textures, Layers::Ground, 10.0f, 0.0f, 0.0f, 1, 1}});
+    string path = Test::TempPath("bad_texture.tmap");
+    bad.Save(path);
+    CHECK_THROWS(TileMap::Load(path));
+
+    TileMap negative({{-1, Layers::Ground, 10.0f, 0.0f, 0.0f, 1, 1}});
+    negative.Save(path);
+    CHECK_THROWS(TileMap::Load(path));
+
+    CHECK_THROWS(TileMap({{Textures::Ground, Layers::Ground, 0.0f, 0.0f, 0.0f, 1, 1}}));
+}
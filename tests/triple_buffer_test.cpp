@@ -0,0 +1,52 @@
+#include "test.hpp"
+
+#include <thread>
+
+#include <triple_buffer.hpp>
+
+TEST(TripleBufferHandsOverTheLatestValue) {
+    TripleBuffer<int> buffer;
+    CHECK(!buffer.Update());
+
+    buffer.Back() = 1;
+    buffer.Publish();
+    CHECK(buffer.Update());
+    CHECK(buffer.Front() == 1);
+    CHECK(!buffer.Update());
+    CHECK(buffer.Front() == 1);
+
+    // Values the reader didn't get to are skipped, not queued
+    buffer.Back() = 2;
+    buffer.Publish();
+    buffer.Back() = 3;
+    buffer.Publish();
+    CHECK(buffer.Update());
+    CHECK(buffer.Front() == 3);
+    CHECK(!buffer.Update());
+}
+
+TEST(TripleBufferReaderNeverSeesATornValue) {
+    struct Value {
+        int a, b;
+    };
+    TripleBuffer<Value> buffer;
+    const int n = 200000;
+
+    thread writer([&]() {
+        for (int i = 1; i <= n; i++) {
+            buffer.Back() = {i, -i};
+            buffer.Publish();
+        }
+    });
+    int last = 0;
+    bool ok = true;
+    while (last < n) {
+        if (!buffer.Update()) continue;
+        const Value& value = buffer.Front();
+        // Whole, and never older than what was already seen
+        ok = ok && value.b == -value.a && value.a > last;
+        last = value.a;
+    }
+    writer.join();
+    CHECK(ok);
+}